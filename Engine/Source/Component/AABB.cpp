@@ -3,6 +3,7 @@
 
 #include <include/glm_utils.h>
 
+#include <Component/ComponentStore.h>
 #include <Component/Transform.h>
 #include <Component/Mesh.h>
 #include <Core/Camera/Camera.h>
@@ -23,6 +24,18 @@ AABB::AABB(GameObject *obj)
 		cout << "file: " << __FILE__ << "line: " << __LINE__ << endl;
 		assert(false);
 	}
+
+	// Streamed meshes have no box until imported - prefabs keep an empty one
+	if (obj->mesh->bbox == nullptr) {
+		Manager::GetComponents()->SetBounds(transform->entity, obj->transform->entity, glm::vec3(0), glm::vec3(0));
+		return;
+	}
+
+	// bbox points are the mesh box corners - first is the max, last the min
+	auto &points = obj->mesh->bbox->points;
+	glm::vec3 center = (points.front() + points.back()) / 2.0f;
+	glm::vec3 halfSize = (points.front() - points.back()) / 2.0f;
+	Manager::GetComponents()->SetBounds(transform->entity, obj->transform->entity, center, halfSize);
 }
 
 AABB::~AABB() {
@@ -37,20 +50,7 @@ void AABB::Init() {
 
 bool AABB::Overlaps(AABB *aabb)
 {
-	//auto posA = glm::rotate(glm::inverse(aabb->transform->rotationQ), aabb->transform->position);
-	//auto posB = glm::rotate(glm::inverse(transform->rotationQ), transform->position);
-	//auto delta = posA - posB;
-	//auto half = halfSize + aabb->halfSize;
-
-	auto q = glm::inverse(transform->rotationQ);
-	auto deltaPos = transform->position - aabb->transform->position;
-	auto delta = glm::rotate(q, deltaPos);
-	auto half = halfSize + aabb->halfSize;
-
-	bool overlapsX = abs(delta.x) < half.x;
-	bool overlapsY =     delta.y  < half.y;
-	bool overlapsZ = abs(delta.z) < half.z;
-	return overlapsX && overlapsY && overlapsZ;
+	return Manager::GetComponents()->Overlaps(transform->entity, aabb->transform->entity);
 }
 
 void AABB::Update()
@@ -60,38 +60,10 @@ void AABB::Update()
 
 void AABB::Update(glm::quat rotationQ)
 {
-	auto q = glm::inverse(rotationQ) * obj->transform->rotationQ;
-
-	glm::vec3 min, max = glm::rotate(q, obj->mesh->bbox->points[0]);
-
-	for (auto point: obj->mesh->bbox->points) {
-
-		point = glm::rotate(q, point);
-
-		// find max
-		if (point.x > max.x)
-			max.x = point.x;
-		if (point.y > max.y)
-			max.y = point.y;
-		if (point.z > max.z)
-			max.z = point.z;
-
-		// find min
-		if (point.x < min.x)
-			min.x = point.x;
-		if (point.y < min.y)
-			min.y = point.y;
-		if (point.z < min.z)
-			min.z = point.z;
-	}
-
-	halfSize = (max - min) / 2.0f * obj->transform->scale;
-	center = (max + min) / 2.0f * obj->transform->scale;
-	center = glm::rotate(rotationQ, center);
-
-	transform->scale = halfSize * 2.0f;
-	transform->position = center + obj->transform->position;
-	transform->SetRotation(rotationQ);
+	// The object may have switched transforms since the volume was created
+	auto store = Manager::GetComponents();
+	store->SetBoundsTarget(transform->entity, obj->transform->entity);
+	store->UpdateBounds(transform->entity, rotationQ);
 }
 
 void AABB::Render(const Shader *shader) const
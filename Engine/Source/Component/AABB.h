@@ -12,6 +12,8 @@ class Shader;
  *	Axis Aligned Bounding Box
  *	default axis are the world axis (OX, OY, OZ)
  *	using a rotation quaternion a different axis can be provided
+ *	The volume lives in the ComponentStore entity of its transform:
+ *	position = center, scale = size, rotation = axis
  */
 class DLLExport AABB
 {
@@ -29,8 +31,4 @@ class DLLExport AABB
 	public:
 		Transform *transform;
 		GameObject *obj;
-
-	private:
-		glm::vec3 center;
-		glm::vec3 halfSize;
 };
\ No newline at end of file
@@ -0,0 +1,488 @@
+//#include <pch.h>
+#include "ComponentStore.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include <Manager/JobSystem.h>
+#include <Manager/Manager.h>
+#include <Manager/Profiler.h>
+
+#define BLOCK_OF(entity) blocks[(entity) / BLOCK_SIZE]
+#define SLOT_OF(entity) ((entity) % BLOCK_SIZE)
+
+static void ComposeModel(glm::mat4 &model, const glm::vec3 &position, const glm::quat &rotation, const glm::vec3 &scale)
+{
+	model = glm::toMat4(rotation);
+	model[0] *= scale[0];
+	model[1] *= scale[1];
+	model[2] *= scale[2];
+	model[3][0] = position[0];
+	model[3][1] = position[1];
+	model[3][2] = position[2];
+}
+
+ComponentStore::ComponentStore()
+{
+	nrBlocks = 0;
+	nrSlots = 0;
+	boundsSpace = glm::quat(0, 0, 0, 0);
+	hierarchyChanged = false;
+	for (unsigned int i = 0; i < MAX_BLOCKS; i++)
+		blocks[i] = nullptr;
+}
+
+ComponentStore::~ComponentStore()
+{
+	for (unsigned int i = 0; i < nrBlocks; i++)
+		delete blocks[i];
+}
+
+EntityID ComponentStore::Create()
+{
+	lock_guard<mutex> guard(lock);
+
+	EntityID entity;
+	if (!freeSlots.empty()) {
+		entity = freeSlots.back();
+		freeSlots.pop_back();
+	}
+	else {
+		entity = nrSlots;
+		if (entity / BLOCK_SIZE == nrBlocks) {
+			assert(nrBlocks < MAX_BLOCKS);
+			blocks[nrBlocks++] = new Block();
+		}
+	}
+
+	Block *block = BLOCK_OF(entity);
+	unsigned int i = SLOT_OF(entity);
+	block->position[i] = glm::vec3(0);
+	block->rotation[i] = glm::quat(1.0f, 0, 0, 0);
+	block->scale[i] = glm::vec3(1.0f);
+	block->model[i] = glm::mat4(1.0f);
+	block->parent[i] = NO_PARENT;
+	block->prevPosition[i] = glm::vec3(0);
+	block->prevRotation[i] = glm::quat(1.0f, 0, 0, 0);
+	block->prevScale[i] = glm::vec3(1.0f);
+	block->localCenter[i] = glm::vec3(0);
+	block->localHalfSize[i] = glm::vec3(0);
+	block->target[i] = entity;
+	block->owner[i] = nullptr;
+	block->flags[i] = ENTITY_ALIVE;
+
+	// Publish the slot only after it is initialized
+	if (entity == nrSlots)
+		nrSlots++;
+
+	return entity;
+}
+
+void ComponentStore::Destroy(EntityID entity)
+{
+	lock_guard<mutex> guard(lock);
+
+	// Detach the entity and its children from the hierarchy
+	if (!hierarchy.empty()) {
+		BLOCK_OF(entity)->parent[SLOT_OF(entity)] = NO_PARENT;
+		for (auto child : hierarchy) {
+			if (BLOCK_OF(child)->parent[SLOT_OF(child)] == entity) {
+				BLOCK_OF(child)->parent[SLOT_OF(child)] = NO_PARENT;
+				BLOCK_OF(child)->flags[SLOT_OF(child)] |= ENTITY_DIRTY;
+			}
+		}
+		hierarchy.erase(remove_if(hierarchy.begin(), hierarchy.end(), [this](EntityID child) {
+			return BLOCK_OF(child)->parent[SLOT_OF(child)] == NO_PARENT;
+		}), hierarchy.end());
+	}
+
+	BLOCK_OF(entity)->flags[SLOT_OF(entity)] = 0;
+	BLOCK_OF(entity)->owner[SLOT_OF(entity)] = nullptr;
+	freeSlots.push_back(entity);
+}
+
+void ComponentStore::Reserve(unsigned int count)
+{
+	lock_guard<mutex> guard(lock);
+
+	unsigned int available = (unsigned int)freeSlots.size();
+	if (count <= available)
+		return;
+
+	unsigned int needed = nrSlots + count - available;
+	while (nrBlocks * BLOCK_SIZE < needed) {
+		assert(nrBlocks < MAX_BLOCKS);
+		blocks[nrBlocks++] = new Block();
+	}
+}
+
+unsigned int ComponentStore::GetSize() const
+{
+	return nrSlots;
+}
+
+glm::vec3& ComponentStore::Position(EntityID entity)
+{
+	return BLOCK_OF(entity)->position[SLOT_OF(entity)];
+}
+
+glm::quat& ComponentStore::Rotation(EntityID entity)
+{
+	return BLOCK_OF(entity)->rotation[SLOT_OF(entity)];
+}
+
+glm::vec3& ComponentStore::Scale(EntityID entity)
+{
+	return BLOCK_OF(entity)->scale[SLOT_OF(entity)];
+}
+
+glm::mat4& ComponentStore::Model(EntityID entity)
+{
+	return BLOCK_OF(entity)->model[SLOT_OF(entity)];
+}
+
+glm::vec3& ComponentStore::PrevPosition(EntityID entity)
+{
+	return BLOCK_OF(entity)->prevPosition[SLOT_OF(entity)];
+}
+
+glm::quat& ComponentStore::PrevRotation(EntityID entity)
+{
+	return BLOCK_OF(entity)->prevRotation[SLOT_OF(entity)];
+}
+
+glm::vec3& ComponentStore::PrevScale(EntityID entity)
+{
+	return BLOCK_OF(entity)->prevScale[SLOT_OF(entity)];
+}
+
+void ComponentStore::SetParent(EntityID entity, EntityID parent)
+{
+	lock_guard<mutex> guard(lock);
+
+	EntityID &current = BLOCK_OF(entity)->parent[SLOT_OF(entity)];
+	if (current == parent)
+		return;
+
+	for (EntityID p = parent; p != NO_PARENT; p = BLOCK_OF(p)->parent[SLOT_OF(p)])
+		assert(p != entity);
+
+	if (current == NO_PARENT)
+		hierarchy.push_back(entity);
+	else if (parent == NO_PARENT)
+		hierarchy.erase(find(hierarchy.begin(), hierarchy.end(), entity));
+
+	current = parent;
+	BLOCK_OF(entity)->flags[SLOT_OF(entity)] |= ENTITY_DIRTY;
+	hierarchyChanged = true;
+}
+
+EntityID ComponentStore::GetParent(EntityID entity) const
+{
+	return BLOCK_OF(entity)->parent[SLOT_OF(entity)];
+}
+
+unsigned int ComponentStore::GetDepth(EntityID entity) const
+{
+	unsigned int depth = 0;
+	for (EntityID p = GetParent(entity); p != NO_PARENT; p = GetParent(p))
+		depth++;
+	return depth;
+}
+
+void ComponentStore::UpdateModel(EntityID entity)
+{
+	Block *block = BLOCK_OF(entity);
+	unsigned int i = SLOT_OF(entity);
+	ComposeModel(block->model[i], block->position[i], block->rotation[i], block->scale[i]);
+	if (block->parent[i] != NO_PARENT) {
+		glm::mat4 parent;
+		GetWorldMatrix(block->parent[i], parent);
+		block->model[i] = parent * block->model[i];
+	}
+	block->flags[i] |= ENTITY_DIRTY;
+}
+
+void ComponentStore::GetWorldMatrix(EntityID entity, glm::mat4 &world) const
+{
+	bool current = true;
+	for (EntityID e = entity; e != NO_PARENT && current; e = GetParent(e)) {
+		unsigned int flags = BLOCK_OF(e)->flags[SLOT_OF(e)];
+		current = !(flags & ENTITY_DIRTY) && (flags & (ENTITY_SIMULATED | ENTITY_STATIC)) != ENTITY_SIMULATED;
+	}
+
+	const Block *block = BLOCK_OF(entity);
+	unsigned int i = SLOT_OF(entity);
+	if (current) {
+		world = block->model[i];
+		return;
+	}
+
+	ComposeModel(world, block->position[i], block->rotation[i], block->scale[i]);
+	if (block->parent[i] != NO_PARENT) {
+		glm::mat4 parent;
+		GetWorldMatrix(block->parent[i], parent);
+		world = parent * world;
+	}
+}
+
+void ComponentStore::GetWorldTransform(EntityID entity, glm::vec3 &position, glm::quat &rotation, glm::vec3 &scale) const
+{
+	const Block *block = BLOCK_OF(entity);
+	unsigned int i = SLOT_OF(entity);
+
+	if (block->parent[i] == NO_PARENT) {
+		position = block->position[i];
+		rotation = block->rotation[i];
+		scale = block->scale[i];
+		return;
+	}
+
+	glm::mat4 M;
+	GetWorldMatrix(entity, M);
+	position = glm::vec3(M[3]);
+	scale = glm::vec3(glm::length(glm::vec3(M[0])), glm::length(glm::vec3(M[1])), glm::length(glm::vec3(M[2])));
+	rotation = glm::quat_cast(glm::mat3(glm::vec3(M[0]) / scale.x, glm::vec3(M[1]) / scale.y, glm::vec3(M[2]) / scale.z));
+}
+
+void ComponentStore::SetFlags(EntityID entity, unsigned int mask, bool value)
+{
+	unsigned int &flags = BLOCK_OF(entity)->flags[SLOT_OF(entity)];
+	flags = value ? (flags | mask) : (flags & ~mask);
+}
+
+bool ComponentStore::HasFlags(EntityID entity, unsigned int mask) const
+{
+	return (BLOCK_OF(entity)->flags[SLOT_OF(entity)] & mask) == mask;
+}
+
+void ComponentStore::SetOwner(EntityID entity, GameObject *owner)
+{
+	BLOCK_OF(entity)->owner[SLOT_OF(entity)] = owner;
+}
+
+GameObject* ComponentStore::GetOwner(EntityID entity) const
+{
+	return BLOCK_OF(entity)->owner[SLOT_OF(entity)];
+}
+
+void ComponentStore::SetBounds(EntityID entity, EntityID target, const glm::vec3 &center, const glm::vec3 &halfSize)
+{
+	Block *block = BLOCK_OF(entity);
+	unsigned int i = SLOT_OF(entity);
+	block->localCenter[i] = center;
+	block->localHalfSize[i] = halfSize;
+	block->target[i] = target;
+}
+
+void ComponentStore::SetBoundsTarget(EntityID entity, EntityID target)
+{
+	BLOCK_OF(entity)->target[SLOT_OF(entity)] = target;
+}
+
+/*
+ *	The volume is the box enclosing the rotated mesh box, expressed in the space axes:
+ *	position = world center, scale = full size, rotation = space
+ */
+void ComponentStore::UpdateBounds(EntityID entity, const glm::quat &space)
+{
+	Block *block = BLOCK_OF(entity);
+	unsigned int i = SLOT_OF(entity);
+
+	glm::vec3 targetPosition, targetScale;
+	glm::quat targetRotation;
+	GetWorldTransform(block->target[i], targetPosition, targetRotation, targetScale);
+
+	glm::quat q = glm::inverse(space) * targetRotation;
+	glm::mat3 R = glm::mat3_cast(q);
+
+	// extent of the rotated box on each axis
+	const glm::vec3 &h = block->localHalfSize[i];
+	glm::vec3 extent;
+	for (int k = 0; k < 3; k++)
+		extent[k] = fabs(R[0][k]) * h.x + fabs(R[1][k]) * h.y + fabs(R[2][k]) * h.z;
+
+	glm::vec3 halfSize = extent * targetScale;
+	glm::vec3 center = glm::rotate(q, block->localCenter[i]) * targetScale;
+
+	block->position[i] = glm::rotate(space, center) + targetPosition;
+	block->scale[i] = halfSize * 2.0f;
+	block->rotation[i] = space;
+	ComposeModel(block->model[i], block->position[i], space, block->scale[i]);
+}
+
+// Overlap test in the space of volume a (the test is not symmetric on OY)
+bool ComponentStore::Overlaps(EntityID a, EntityID b) const
+{
+	const Block *blockA = BLOCK_OF(a);
+	const Block *blockB = BLOCK_OF(b);
+	unsigned int i = SLOT_OF(a);
+	unsigned int j = SLOT_OF(b);
+
+	glm::vec3 delta = glm::rotate(glm::inverse(blockA->rotation[i]), blockA->position[i] - blockB->position[j]);
+	glm::vec3 half = (blockA->scale[i] + blockB->scale[j]) * 0.5f;
+
+	return fabs(delta.x) < half.x && delta.y < half.y && fabs(delta.z) < half.z;
+}
+
+void ComponentStore::GetWorldBounds(EntityID entity, glm::vec3 &min, glm::vec3 &max) const
+{
+	const Block *block = BLOCK_OF(entity);
+	unsigned int i = SLOT_OF(entity);
+
+	glm::vec3 targetPosition, targetScale;
+	glm::quat targetRotation;
+	GetWorldTransform(block->target[i], targetPosition, targetRotation, targetScale);
+
+	glm::mat3 R = glm::mat3_cast(targetRotation);
+	glm::vec3 h = block->localHalfSize[i] * targetScale;
+
+	glm::vec3 extent;
+	for (int k = 0; k < 3; k++)
+		extent[k] = fabs(R[0][k]) * h.x + fabs(R[1][k]) * h.y + fabs(R[2][k]) * h.z;
+
+	glm::vec3 center = targetPosition + R * (block->localCenter[i] * targetScale);
+	min = center - extent;
+	max = center + extent;
+}
+
+void ComponentStore::SetVolumeFlags(const vector<EntityID> &volumes, unsigned int mask, bool value)
+{
+	for (auto entity : volumes) {
+		SetFlags(entity, mask, value);
+		SetFlags(BLOCK_OF(entity)->target[SLOT_OF(entity)], mask, value);
+	}
+}
+
+void ComponentStore::ParallelForBlocks(function<void(Block*, unsigned int, unsigned int)> func)
+{
+	unsigned int size = nrSlots;
+	unsigned int count = (size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+	Manager::GetJobs()->ParallelFor(count, 1, [&](unsigned int start, unsigned int end) {
+		for (unsigned int b = start; b < end; b++) {
+			unsigned int first = b * BLOCK_SIZE;
+			func(blocks[b], first, size - first < BLOCK_SIZE ? size - first : BLOCK_SIZE);
+		}
+	});
+}
+
+// Snapshot scene transforms before a simulation tick
+void ComponentStore::SaveState()
+{
+	PROFILE_SCOPE("Save State");
+
+	unsigned int size = nrSlots;
+	for (unsigned int b = 0; b * BLOCK_SIZE < size; b++) {
+		Block *block = blocks[b];
+		unsigned int count = size - b * BLOCK_SIZE < BLOCK_SIZE ? size - b * BLOCK_SIZE : BLOCK_SIZE;
+		for (unsigned int i = 0; i < count; i++) {
+			if ((block->flags[i] & (ENTITY_SIMULATED | ENTITY_STATIC)) != ENTITY_SIMULATED)
+				continue;
+			block->prevPosition[i] = block->position[i];
+			block->prevRotation[i] = block->rotation[i];
+			block->prevScale[i] = block->scale[i];
+		}
+	}
+}
+
+// Local matrix of a slot - scene transforms are blended between the last two
+// ticks, static and free transforms snap to their current state
+static bool ComposeLocal(ComponentStore::Block *block, unsigned int i, float alpha, glm::mat4 &local)
+{
+	unsigned int &flags = block->flags[i];
+	if ((flags & (ENTITY_SIMULATED | ENTITY_STATIC)) == ENTITY_SIMULATED) {
+		ComposeModel(local,
+			glm::mix(block->prevPosition[i], block->position[i], alpha),
+			glm::slerp(block->prevRotation[i], block->rotation[i], alpha),
+			glm::mix(block->prevScale[i], block->scale[i], alpha));
+		return true;
+	}
+
+	if (!(flags & ENTITY_DIRTY))
+		return false;
+
+	if (flags & ENTITY_SIMULATED) {
+		block->prevPosition[i] = block->position[i];
+		block->prevRotation[i] = block->rotation[i];
+		block->prevScale[i] = block->scale[i];
+	}
+	ComposeModel(local, block->position[i], block->rotation[i], block->scale[i]);
+	return true;
+}
+
+// Rebuild the model matrices changed since the last frame
+void ComponentStore::Interpolate(float alpha)
+{
+	ParallelForBlocks([alpha](Block *block, unsigned int first, unsigned int count) {
+		for (unsigned int i = 0; i < count; i++) {
+			unsigned int &flags = block->flags[i];
+			flags &= ~ENTITY_MOVED;
+
+			// Children are composed by the hierarchy pass and volumes by UpdateBounds
+			if (block->parent[i] != NO_PARENT || (flags & ENTITY_BOUNDS))
+				continue;
+
+			if (ComposeLocal(block, i, alpha, block->model[i]))
+				flags = (flags & ~ENTITY_DIRTY) | ENTITY_MOVED;
+		}
+	});
+
+	UpdateHierarchy(alpha);
+}
+
+// Parents come first, so their world matrix is final when a child reads it
+void ComponentStore::UpdateHierarchy(float alpha)
+{
+	PROFILE_SCOPE("Transform Hierarchy");
+	lock_guard<mutex> guard(lock);
+
+	if (hierarchyChanged) {
+		vector<pair<unsigned int, EntityID>> order;
+		order.reserve(hierarchy.size());
+		for (auto entity : hierarchy)
+			order.push_back(make_pair(GetDepth(entity), entity));
+		sort(order.begin(), order.end());
+
+		for (unsigned int k = 0; k < order.size(); k++)
+			hierarchy[k] = order[k].second;
+		hierarchyChanged = false;
+	}
+
+	glm::mat4 local;
+	for (auto entity : hierarchy) {
+		Block *block = BLOCK_OF(entity);
+		unsigned int i = SLOT_OF(entity);
+		unsigned int &flags = block->flags[i];
+		EntityID parent = block->parent[i];
+
+		if (HasFlags(parent, ENTITY_MOVED))
+			flags |= ENTITY_DIRTY;
+
+		if (ComposeLocal(block, i, alpha, local)) {
+			block->model[i] = Model(parent) * local;
+			flags = (flags & ~ENTITY_DIRTY) | ENTITY_MOVED;
+		}
+	}
+}
+
+void ComponentStore::UpdateBounds(const glm::quat &space)
+{
+	// Cached static bounds stay valid while the space is the same
+	bool spaceChanged = space != boundsSpace;
+	boundsSpace = space;
+
+	ParallelForBlocks([this, &space, spaceChanged](Block *block, unsigned int first, unsigned int count) {
+		PROFILE_SCOPE("Bounding Box Batch");
+		for (unsigned int i = 0; i < count; i++) {
+			unsigned int &flags = block->flags[i];
+			if (!(flags & ENTITY_BOUNDS))
+				continue;
+			if ((flags & (ENTITY_STATIC | ENTITY_DIRTY)) == ENTITY_STATIC && !spaceChanged)
+				continue;
+			UpdateBounds(first + i, space);
+			flags &= ~ENTITY_DIRTY;
+		}
+	});
+}
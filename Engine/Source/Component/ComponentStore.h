@@ -0,0 +1,166 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include <include/dll_export.h>
+#include <include/glm.h>
+
+class GameObject;
+
+using namespace std;
+
+typedef unsigned int EntityID;
+
+enum EntityFlags {
+	ENTITY_ALIVE		= 1 << 0,
+	ENTITY_SIMULATED	= 1 << 1,	// transform of a scene object - saved and interpolated every tick
+	ENTITY_BOUNDS		= 1 << 2,	// bounding volume of a scene object - updated and culled by the sweeps
+	ENTITY_VISIBLE		= 1 << 3,	// written by culling on both the volume and its target
+	ENTITY_CAST_SHADOW	= 1 << 4,
+	ENTITY_IN_VIEW		= 1 << 5,	// inside the camera frustum planes - subset of the visible entities
+	ENTITY_STATIC		= 1 << 6,	// never moves - skipped by the sweeps unless dirty
+	ENTITY_DIRTY		= 1 << 7,	// transform changed since the last sweep
+	ENTITY_MOVED		= 1 << 8	// model rebuilt by the last transform pass - children follow
+};
+
+/*
+ *	Structure-of-arrays storage for the per-frame data of every entity
+ *	Slots live in fixed size blocks that never move, so component facades
+ *	(Transform) can bind references to their slot and keep the member syntax
+ *	Released slots are recycled first so the sweeps stay over a compact range
+ *	Transforms can have a parent: position, rotation and scale are then relative
+ *	to it and model is the world matrix
+ */
+class DLLExport ComponentStore
+{
+	public:
+		static const unsigned int BLOCK_SIZE = 256;
+		static const unsigned int MAX_BLOCKS = 1024;
+		static const EntityID NO_PARENT = 0xFFFFFFFF;
+
+		struct Block {
+			// transform
+			glm::vec3 position[BLOCK_SIZE];
+			glm::quat rotation[BLOCK_SIZE];
+			glm::vec3 scale[BLOCK_SIZE];
+			glm::mat4 model[BLOCK_SIZE];
+			EntityID parent[BLOCK_SIZE];
+
+			// transform at the previous simulation tick
+			glm::vec3 prevPosition[BLOCK_SIZE];
+			glm::quat prevRotation[BLOCK_SIZE];
+			glm::vec3 prevScale[BLOCK_SIZE];
+
+			// bounds - mesh space box and the entity it follows
+			glm::vec3 localCenter[BLOCK_SIZE];
+			glm::vec3 localHalfSize[BLOCK_SIZE];
+			EntityID target[BLOCK_SIZE];
+
+			unsigned int flags[BLOCK_SIZE];
+			GameObject *owner[BLOCK_SIZE];
+		};
+
+	protected:
+		ComponentStore();
+		~ComponentStore();
+
+	public:
+		EntityID Create();
+		void Destroy(EntityID entity);
+
+		// Allocate the blocks for count more entities up front
+		void Reserve(unsigned int count);
+
+		glm::vec3& Position(EntityID entity);
+		glm::quat& Rotation(EntityID entity);
+		glm::vec3& Scale(EntityID entity);
+		glm::mat4& Model(EntityID entity);
+		glm::vec3& PrevPosition(EntityID entity);
+		glm::quat& PrevRotation(EntityID entity);
+		glm::vec3& PrevScale(EntityID entity);
+
+		// Parent must not be a descendant of the entity - NO_PARENT detaches it
+		void SetParent(EntityID entity, EntityID parent);
+		EntityID GetParent(EntityID entity) const;
+
+		// Rebuild the model matrix now (the transform pass picks up the children)
+		void UpdateModel(EntityID entity);
+
+		// World matrix of the current state - model unless the entity or a parent changed
+		// since the transform pass or is simulated (model is then blended between ticks)
+		void GetWorldMatrix(EntityID entity, glm::mat4 &world) const;
+
+		// World space position, rotation and scale - the local ones for root entities
+		void GetWorldTransform(EntityID entity, glm::vec3 &position, glm::quat &rotation, glm::vec3 &scale) const;
+
+		void SetFlags(EntityID entity, unsigned int mask, bool value);
+		bool HasFlags(EntityID entity, unsigned int mask) const;
+
+		// Scene object the entity belongs to (only set while in the scene)
+		void SetOwner(EntityID entity, GameObject *owner);
+		GameObject* GetOwner(EntityID entity) const;
+
+		// Make entity a bounding volume of target, using a mesh space box
+		void SetBounds(EntityID entity, EntityID target, const glm::vec3 &center, const glm::vec3 &halfSize);
+		void SetBoundsTarget(EntityID entity, EntityID target);
+
+		// Recompute a bounding volume aligned to the axes given by space
+		void UpdateBounds(EntityID entity, const glm::quat &space);
+		bool Overlaps(EntityID a, EntityID b) const;
+
+		// World axis box of a bounding volume, from the current transform of its target
+		void GetWorldBounds(EntityID entity, glm::vec3 &min, glm::vec3 &max) const;
+
+		// Set flags on the volumes and their targets
+		void SetVolumeFlags(const vector<EntityID> &volumes, unsigned int mask, bool value);
+
+		// Sweeps over the whole store
+		// Static entities keep their cached model and bounds until marked dirty
+		// or, for the bounds, until the space changes
+		// Interpolate is the per-frame transform pass: scene transforms are blended,
+		// the other ones are rebuilt only when dirty, then children in hierarchy order
+		void SaveState();
+		void Interpolate(float alpha);
+		void UpdateBounds(const glm::quat &space);
+
+		// Call func(entity) for every entity having all the bits of mask
+		template <class F>
+		void ForEach(unsigned int mask, F func) const;
+
+		unsigned int GetSize() const;
+
+	private:
+		void ParallelForBlocks(function<void(Block*, unsigned int, unsigned int)> func);
+		void UpdateHierarchy(float alpha);
+		unsigned int GetDepth(EntityID entity) const;
+
+	private:
+		Block *blocks[MAX_BLOCKS];
+		unsigned int nrBlocks;
+		atomic<unsigned int> nrSlots;
+		vector<EntityID> freeSlots;
+		mutex lock;
+
+		// space of the cached static bounds
+		glm::quat boundsSpace;
+
+		// Entities having a parent, sorted by depth when the hierarchy changes
+		vector<EntityID> hierarchy;
+		bool hierarchyChanged;
+};
+
+template <class F>
+void ComponentStore::ForEach(unsigned int mask, F func) const
+{
+	unsigned int size = nrSlots;
+	for (unsigned int b = 0; b * BLOCK_SIZE < size; b++) {
+		const Block *block = blocks[b];
+		unsigned int count = size - b * BLOCK_SIZE < BLOCK_SIZE ? size - b * BLOCK_SIZE : BLOCK_SIZE;
+		for (unsigned int i = 0; i < count; i++) {
+			if ((block->flags[i] & mask) == mask)
+				func(b * BLOCK_SIZE + i);
+		}
+	}
+}
@@ -9,11 +9,23 @@
 #include <GPU/Material.h>
 
 #include <Manager/Manager.h>
+#include <Manager/Profiler.h>
 #include <Manager/ResourceManager.h>
 #include <Manager/TextureManager.h>
 
+#include <Rendering/RenderQueue.h>
+
+#include <Utils/3D.h>
 #include <Utils/GPU.h>
 
+// Screen height fraction under which each level is used
+static const float LOD_SCREEN_SIZE[MAX_MESH_LODS] = { 1.0f, 0.25f, 0.1f, 0.04f };
+static const float LOD_HYSTERESIS = 0.15f;
+
+// Smallest level worth simplifying and the reduction a new level must reach
+static const unsigned int LOD_MIN_TRIANGLES = 64;
+static const float LOD_MIN_REDUCTION = 0.85f;
+
 Mesh::Mesh(const char* meshID)
 {
 	if (meshID)
@@ -22,11 +34,19 @@ Mesh::Mesh(const char* meshID)
 	useMaterial = true;
 	debugColor = glm::vec4(1);
 	glPrimitive = GL_TRIANGLES;
+	nrLods = 1;
+	bbox = nullptr;
+	buffers = nullptr;
+	streamed = false;
+	users = 0;
+	residency = (int)MeshResidency::RESIDENT;
 }
 
 Mesh::~Mesh() {
 	Clear();
 	delete buffers;
+	for (auto &pending : pendingTextures)
+		SAFE_FREE(pending.texture);
 }
 
 
@@ -40,6 +60,8 @@ void Mesh::Clear()
 
 bool Mesh::LoadMesh(const string& fileLocation, const string& fileName)
 {
+	PROFILE_SCOPE("Load Mesh");
+
 	Clear();
 	this->fileLocation = fileLocation;
 	string file = (fileLocation + '\\' + fileName).c_str();
@@ -89,7 +111,16 @@ bool Mesh::InitFromData(vector<glm::vec3>& positions,
 
 bool Mesh::InitFromScene(const aiScene* pScene)
 {
+	if (!ImportScene(pScene))
+		return false;
+
+	buffers = UtilsGPU::UploadData(positions, normals, texCoords, indices);
+	return buffers->VAO != -1;
+}
 
+// Everything but the GPU upload - safe on a worker for streamed meshes
+bool Mesh::ImportScene(const aiScene* pScene)
+{
 	meshEntries.resize(pScene->mNumMeshes);
 	materials.resize(pScene->mNumMaterials);
 
@@ -123,8 +154,52 @@ bool Mesh::InitFromScene(const aiScene* pScene)
 	if (useMaterial && !InitMaterials(pScene))
 		return false;
 
-	buffers = UtilsGPU::UploadData(positions, normals, texCoords, indices);
-	return buffers->VAO != -1;
+	if (meshType == MeshType::STATIC && glPrimitive == GL_TRIANGLES)
+		GenerateLODs();
+
+	return true;
+}
+
+// Each level halves the triangles of the previous one - the indices are appended
+// after the full detail ones, so all levels share the vertex and index buffers
+void Mesh::GenerateLODs()
+{
+	PROFILE_SCOPE("Generate LODs");
+	vector<unsigned short> simplified;
+
+	for (unsigned int i = 0; i < meshEntries.size(); i++) {
+		MeshEntry *entry = meshEntries[i];
+		unsigned int vertexEnd = i + 1 < meshEntries.size() ? meshEntries[i + 1]->baseVertex : (unsigned int)positions.size();
+		unsigned int nrVertices = vertexEnd - entry->baseVertex;
+
+		MeshLOD previous;
+		previous.baseIndex = entry->baseIndex;
+		previous.nrIndices = entry->nrIndices;
+		bool reduced = entry->nrIndices >= LOD_MIN_TRIANGLES * 3;
+
+		for (unsigned int k = 1; k < MAX_MESH_LODS; k++) {
+			MeshLOD &lod = entry->lods[k - 1];
+			lod = previous;
+			if (!reduced)
+				continue;
+
+			unsigned int target = previous.nrIndices / 6 * 3;
+			Utils3D::SimplifyMesh(&positions[entry->baseVertex], nrVertices,
+								  &indices[previous.baseIndex], previous.nrIndices, target, simplified);
+
+			// Not worth a level - the coarser levels repeat this one
+			if (simplified.size() > previous.nrIndices * LOD_MIN_REDUCTION) {
+				reduced = false;
+				continue;
+			}
+
+			lod.baseIndex = (unsigned int)indices.size();
+			lod.nrIndices = (unsigned int)simplified.size();
+			indices.insert(indices.end(), simplified.begin(), simplified.end());
+			previous = lod;
+			nrLods = k + 1 > nrLods ? k + 1 : nrLods;
+		}
+	}
 }
 
 void Mesh::InitMesh(const aiMesh* paiMesh)
@@ -168,7 +243,22 @@ bool Mesh::InitMaterials(const aiScene* pScene)
 		if (pMaterial->GetTextureCount(aiTextureType_DIFFUSE) > 0) {
 			aiString Path;
 			if (pMaterial->GetTexture(aiTextureType_DIFFUSE, 0, &Path, NULL, NULL, NULL, NULL, NULL) == AI_SUCCESS) {
-				materials[i]->texture = Manager::Texture->LoadTexture(fileLocation, Path.data);
+				if (streamed) {
+					// Decoded here, created by Upload - textures already loaded are only looked up
+					PendingTexture pending;
+					pending.material = i;
+					pending.name = Path.data;
+					pending.texture = nullptr;
+					if (!Manager::Texture->IsLoaded(Path.data)) {
+						pending.texture = new Texture();
+						if (!pending.texture->Decode((fileLocation + '\\' + Path.data).c_str()))
+							SAFE_FREE(pending.texture);
+					}
+					pendingTextures.push_back(pending);
+				}
+				else {
+					materials[i]->texture = Manager::Texture->LoadTexture(fileLocation, Path.data);
+				}
 			}
 
 			if (aiGetMaterialColor(pMaterial, AI_MATKEY_COLOR_AMBIENT, &color) == AI_SUCCESS)
@@ -188,7 +278,8 @@ bool Mesh::InitMaterials(const aiScene* pScene)
 		}
 	}
 
-	CheckOpenGLError();
+	if (!streamed)
+		CheckOpenGLError();
 
 	return ret;
 }
@@ -202,36 +293,267 @@ void Mesh::SetGlPrimitive(unsigned int glPrimitive)
 	this->glPrimitive = glPrimitive;
 }
 
+void Mesh::GetTriangles(vector<glm::vec3> &triangles) const
+{
+	triangles.clear();
+	unsigned int faceSize = glPrimitive == GL_TRIANGLES ? 3 : (glPrimitive == GL_QUADS ? 4 : 0);
+	if (!faceSize)
+		return;
+
+	for (auto entry : meshEntries) {
+		if (!entry->nrIndices)
+			continue;
+		const unsigned short *face = &indices[entry->baseIndex];
+		const glm::vec3 *vertices = &positions[entry->baseVertex];
+		for (unsigned int i = 0; i + faceSize <= entry->nrIndices; i += faceSize, face += faceSize) {
+			triangles.push_back(vertices[face[0]]);
+			triangles.push_back(vertices[face[1]]);
+			triangles.push_back(vertices[face[2]]);
+			if (faceSize == 4) {
+				triangles.push_back(vertices[face[0]]);
+				triangles.push_back(vertices[face[2]]);
+				triangles.push_back(vertices[face[3]]);
+			}
+		}
+	}
+}
+
+unsigned int Mesh::GetLODCount() const
+{
+	return nrLods;
+}
+
+// Moving to another level needs the size to pass the threshold by LOD_HYSTERESIS,
+// so objects around a threshold do not switch every frame
+unsigned int Mesh::SelectLOD(float screenSize, unsigned int current) const
+{
+	unsigned int lod = current < nrLods ? current : nrLods - 1;
+	while (lod + 1 < nrLods && screenSize < LOD_SCREEN_SIZE[lod + 1] * (1 - LOD_HYSTERESIS))
+		lod++;
+	while (lod > 0 && screenSize > LOD_SCREEN_SIZE[lod] * (1 + LOD_HYSTERESIS))
+		lod--;
+	return lod;
+}
+
 void Mesh::Render(const Shader *shader)
 {
-	glBindVertexArray(buffers->VAO);
-	for (unsigned int i = 0 ; i < meshEntries.size() ; i++) {
+	RenderLOD(shader, 0);
+}
 
-		if (useMaterial) {
-			const unsigned int materialIndex = meshEntries[i]->materialIndex;
-			if (materialIndex != INVALID_MATERIAL && materials[materialIndex]->texture) {
-				(materials[materialIndex]->texture)->Bind(GL_TEXTURE0);
-				glBindBufferBase(GL_UNIFORM_BUFFER, 0, materials[materialIndex]->material_ubo);
-			}
-			else {
-				Manager::Texture->GetTexture(unsigned int(0))->Bind(GL_TEXTURE0);
-			}
+const Material* Mesh::GetFirstMaterial() const
+{
+	if (!useMaterial || meshEntries.empty() || meshEntries[0]->materialIndex == INVALID_MATERIAL)
+		return nullptr;
+	return materials[meshEntries[0]->materialIndex];
+}
+
+void Mesh::SetStreamed(const string& fileLocation, const string& fileName)
+{
+	this->fileLocation = fileLocation;
+	this->fileName = fileName;
+	streamed = true;
+	residency = (int)MeshResidency::UNLOADED;
+}
+
+bool Mesh::IsStreamed() const
+{
+	return streamed;
+}
+
+MeshResidency Mesh::GetResidency() const
+{
+	return (MeshResidency)residency.load();
+}
+
+bool Mesh::BeginImport()
+{
+	int expected = (int)MeshResidency::UNLOADED;
+	return residency.compare_exchange_strong(expected, (int)MeshResidency::IMPORTING);
+}
+
+// Runs on a worker - no GL calls until Upload
+void Mesh::Import()
+{
+	PROFILE_SCOPE("Import Mesh");
+	string file = fileLocation + '\\' + fileName;
+
+	Assimp::Importer Importer;
+
+	unsigned int flags = aiProcess_GenSmoothNormals | aiProcess_FlipUVs;
+	if (glPrimitive == GL_TRIANGLES) flags |= aiProcess_Triangulate;
+
+	const aiScene* pScene = Importer.ReadFile(file, flags);
+
+	// Rebuilt from the imported positions - AABBs copy the box when they are made
+	SAFE_FREE(bbox);
+
+	if (!pScene || !ImportScene(pScene)) {
+		cout << "Error: Mesh could not be imported => '" << file << "'" << endl;
+		residency = (int)MeshResidency::FAILED;
+		return;
+	}
+
+	residency = (int)MeshResidency::IMPORTED;
+}
+
+void Mesh::Upload()
+{
+	if (GetResidency() != MeshResidency::IMPORTED)
+		return;
+
+	PROFILE_SCOPE("Upload Mesh");
+
+	// Another mesh may have loaded the texture since the import
+	for (auto &pending : pendingTextures) {
+		Texture *texture = Manager::Texture->GetTexture(pending.name.c_str());
+		if (!texture && pending.texture && pending.texture->Upload()) {
+			texture = pending.texture;
+			Manager::Texture->AddTexture(pending.name.c_str(), texture);
+		}
+		else {
+			SAFE_FREE(pending.texture);
 		}
+		materials[pending.material]->texture = texture ? texture : Manager::Texture->GetTexture((unsigned int)0);
+	}
+	pendingTextures.clear();
 
-		glDrawElementsBaseVertex(glPrimitive,
-								meshEntries[i]->nrIndices,
-								GL_UNSIGNED_SHORT,
-								(void*)(sizeof(unsigned short) * meshEntries[i]->baseIndex),
-								meshEntries[i]->baseVertex);
+	buffers = UtilsGPU::UploadData(positions, normals, texCoords, indices);
+	residency = (int)MeshResidency::RESIDENT;
+}
 
-		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+void Mesh::Acquire()
+{
+	users++;
+}
+
+void Mesh::Release()
+{
+	users--;
+}
+
+unsigned int Mesh::GetUsers() const
+{
+	return users;
+}
+
+// Textures stay with the TextureManager - other meshes may use them
+void Mesh::Evict()
+{
+	// The worker still writes the data - the next user finds the mesh imported
+	if (GetResidency() == MeshResidency::IMPORTING)
+		return;
+
+	Clear();
+	materials.clear();
+	for (auto entry : meshEntries)
+		delete entry;
+	meshEntries.clear();
+	for (auto &pending : pendingTextures)
+		SAFE_FREE(pending.texture);
+	pendingTextures.clear();
+
+	vector<glm::vec3>().swap(positions);
+	vector<glm::vec3>().swap(normals);
+	vector<glm::vec2>().swap(texCoords);
+	vector<unsigned short>().swap(indices);
+	SAFE_FREE(buffers);
+	nrLods = 1;
+
+	residency = (int)MeshResidency::UNLOADED;
+}
+
+void Mesh::BindMaterial(unsigned int entry, DrawState *state) const
+{
+	const unsigned int materialIndex = meshEntries[entry]->materialIndex;
+	bool hasTexture = materialIndex != INVALID_MATERIAL && materials[materialIndex]->texture;
+	Texture *texture = hasTexture ? materials[materialIndex]->texture : Manager::Texture->GetTexture((unsigned int)0);
+
+	if (!state) {
+		texture->Bind(GL_TEXTURE0);
+		if (hasTexture)
+			glBindBufferBase(GL_UNIFORM_BUFFER, 0, materials[materialIndex]->material_ubo);
+		return;
+	}
+
+	if (state->texture != texture->GetTextureID()) {
+		texture->Bind(GL_TEXTURE0);
+		state->texture = texture->GetTextureID();
+		state->binds++;
+	}
+	else {
+		state->bindsAvoided++;
+	}
+
+	if (!hasTexture)
+		return;
+
+	if (state->materialUBO != materials[materialIndex]->material_ubo) {
+		glBindBufferBase(GL_UNIFORM_BUFFER, 0, materials[materialIndex]->material_ubo);
+		state->materialUBO = materials[materialIndex]->material_ubo;
+		state->binds++;
+	}
+	else {
+		state->bindsAvoided++;
 	}
-	glBindVertexArray(0);
+}
+
+void Mesh::RenderLOD(const Shader *shader, unsigned int lod, DrawState *state, unsigned int instances)
+{
+	// Streamed mesh that failed to import
+	if (!buffers)
+		return;
+
+	lod = lod < nrLods ? lod : nrLods - 1;
+
+	if (!state || state->VAO != buffers->VAO) {
+		glBindVertexArray(buffers->VAO);
+		if (state) {
+			state->VAO = buffers->VAO;
+			state->binds++;
+		}
+	}
+	else {
+		state->bindsAvoided++;
+	}
+
+	for (unsigned int i = 0 ; i < meshEntries.size() ; i++) {
+
+		if (useMaterial)
+			BindMaterial(i, state);
+
+		unsigned int nrIndices = lod ? meshEntries[i]->lods[lod - 1].nrIndices : meshEntries[i]->nrIndices;
+		unsigned int baseIndex = lod ? meshEntries[i]->lods[lod - 1].baseIndex : meshEntries[i]->baseIndex;
+
+		if (instances > 1) {
+			glDrawElementsInstancedBaseVertex(glPrimitive,
+											nrIndices,
+											GL_UNSIGNED_SHORT,
+											(void*)(sizeof(unsigned short) * baseIndex),
+											instances,
+											meshEntries[i]->baseVertex);
+		}
+		else {
+			glDrawElementsBaseVertex(glPrimitive,
+									nrIndices,
+									GL_UNSIGNED_SHORT,
+									(void*)(sizeof(unsigned short) * baseIndex),
+									meshEntries[i]->baseVertex);
+		}
+
+		if (!state)
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	}
+
+	if (!state)
+		glBindVertexArray(0);
 }
 
 void Mesh::RenderInstanced(unsigned int instances)
 {
 	instances = instances < 1 ? 1 : instances;
+	if (!buffers)
+		return;
+
 	glBindVertexArray(buffers->VAO);
 	for (unsigned int i = 0; i < meshEntries.size(); i++) {
 
@@ -1,4 +1,5 @@
 #pragma once
+#include <atomic>
 #include <vector>
 
 #include <assimp/Importer.hpp>		// C++ importer interface
@@ -15,8 +16,10 @@ class Shader;
 class Texture;
 class Material;
 class GPUBuffers;
+struct DrawState;
 
 static const unsigned int INVALID_MATERIAL = 0xFFFFFFFF;
+static const unsigned int MAX_MESH_LODS = 4;
 
 enum class MeshType {
 	STATIC,
@@ -24,6 +27,21 @@ enum class MeshType {
 	SKINNED
 };
 
+// Meshes loaded with the resources are resident - streamed ones go through the other states
+enum class MeshResidency {
+	UNLOADED,
+	IMPORTING,		// read on a worker
+	IMPORTED,		// waiting for the main thread upload
+	RESIDENT,
+	FAILED			// the file could not be read - nothing is drawn
+};
+
+// Index range of a simplified level - same vertices as the full detail one
+struct MeshLOD {
+	unsigned int nrIndices;
+	unsigned int baseIndex;
+};
+
 struct MeshEntry {
 	MeshEntry()
 	{
@@ -32,10 +50,13 @@ struct MeshEntry {
 		baseIndex = 0;
 		materialIndex = INVALID_MATERIAL;
 	}
-	unsigned short nrIndices;
+	unsigned int nrIndices;
 	unsigned short baseVertex;
-	unsigned short baseIndex;
+	unsigned int baseIndex;
 	unsigned int materialIndex;
+
+	// levels 1 to nrLods - 1 of the mesh
+	MeshLOD lods[MAX_MESH_LODS - 1];
 };
 
 /**
@@ -64,20 +85,71 @@ class DLLExport Mesh {
 		virtual void Update() {};
 		virtual bool LoadMesh(const string& fileLocation, const string& fileName);
 		virtual void Render(const Shader *shader);
+
+		// With a state, binds matching the previous draw are skipped and the
+		// vertex array stays bound (see RenderQueue)
+		// More than one instance issues an instanced draw - the shader reads the models from
+		// the bound instance buffer (see InstanceBuffer)
+		void RenderLOD(const Shader *shader, unsigned int lod, DrawState *state = nullptr, unsigned int instances = 1);
 		virtual void RenderInstanced(unsigned int instances);
 		virtual void RenderDebug();
 		virtual void UseMaterials(bool);
 
 		void SetGlPrimitive(unsigned int glPrimitive);
 
+		// Model space triangle list of the mesh (quads are split)
+		void GetTriangles(vector<glm::vec3> &triangles) const;
+
+		// Level 0 is the full detail - coarser levels are generated at import for static meshes
+		unsigned int GetLODCount() const;
+
+		// Level for an object covering screenSize of the screen height, given its current level
+		unsigned int SelectLOD(float screenSize, unsigned int current) const;
+
+		// Material of the first entry - nullptr without materials
+		const Material* GetFirstMaterial() const;
+
+		// Streamed meshes only keep their file until a user needs them (see WorldPartition)
+		// BeginImport claims the import of an unloaded mesh for the caller, who then runs
+		// Import on any thread - Upload finishes it on the main thread
+		void SetStreamed(const string& fileLocation, const string& fileName);
+		bool IsStreamed() const;
+		MeshResidency GetResidency() const;
+		bool BeginImport();
+		void Import();
+		void Upload();
+
+		// Users of a streamed mesh - counted on the main thread
+		// Evict drops the data once no user and no pending packet needs it (see WorldPartition)
+		// The bounding box is kept for the instances made afterwards
+		void Acquire();
+		void Release();
+		unsigned int GetUsers() const;
+		void Evict();
+
 	protected:
 		void Clear();
 		void InitMesh(const aiMesh* paiMesh);
 		bool InitMaterials(const aiScene* pScene);
 		virtual bool InitFromScene(const aiScene* pScene);
+		bool ImportScene(const aiScene* pScene);
+		void GenerateLODs();
+		void BindMaterial(unsigned int entry, DrawState *state) const;
 
 	private:
+		// Diffuse texture decoded by Import - registered with the TextureManager on Upload
+		struct PendingTexture {
+			unsigned int material;
+			string name;
+			Texture *texture;
+		};
+
 		string meshID;
+		string fileName;
+		bool streamed;
+		unsigned int users;
+		atomic<int> residency;
+		vector<PendingTexture> pendingTextures;
 
 	public:
 		MeshType meshType;
@@ -93,6 +165,7 @@ class DLLExport Mesh {
 
 		bool useMaterial;
 		unsigned int glPrimitive;
+		unsigned int nrLods;
 		GPUBuffers *buffers;
 
 		vector<MeshEntry*> meshEntries;
@@ -68,6 +68,13 @@ void Physics::RemoveFromWorld() {
 void Physics::Deactivate() {
 }
 
+void Physics::ResetVelocity() {
+	Manager::Havok->MarkForWrite();
+	body->setLinearVelocity(hkVector4(0, 0, 0, 0));
+	body->setAngularVelocity(hkVector4(0, 0, 0, 0));
+	Manager::Havok->UnmarkForWrite();
+}
+
 void Physics::SetPosition(glm::vec3 pos) {
 	Manager::Havok->MarkForWrite();
 	body->setPosition(hkVector4(pos.x, pos.y, pos.z, 0));
@@ -25,6 +25,7 @@ class DLLExport Physics: virtual public Object {
 		virtual void RemoveFromWorld();
 		virtual void Deactivate();
 		virtual void SetPosition(glm::vec3 pos);
+		void ResetVelocity();
 
 	protected:
 		GameObject *parent;
@@ -5,11 +5,14 @@
 #include <include/assimp_utils.h>
 
 #include <Component/Transform.h>
+#include <Core/Engine.h>
 #include <GPU/Shader.h>
 #include <GPU/Texture.h>
 #include <GPU/Material.h>
+#include <GPU/RingBuffer.h>
 
 #include <Manager/Manager.h>
+#include <Manager/RenderingSystem.h>
 #include <Manager/TextureManager.h>
 #include <Manager/ShaderManager.h>
 
@@ -136,7 +139,7 @@ void SkinnedMesh::InitMesh(const aiMesh* paiMesh, unsigned int index)
 
 void SkinnedMesh::Update()
 {
-	float timeInSeconds = (float)glfwGetTime();
+	float timeInSeconds = (float)Engine::GetElapsedTime();
 	UpdateAnimation(timeInSeconds);
 }
 
@@ -262,8 +265,9 @@ void SkinnedMesh::ReadNodeHeirarchy(float animationTime, const aiNode* pNode, co
 
 	const aiNodeAnim* pNodeAnim = FindNodeAnim(animationState, NodeName);
 
-	Transform boneT;
-	assimp::CopyMatix(pNode->mTransformation, boneT.model);
+	// Composed like Transform::Update - a Transform per node would allocate a store entity
+	glm::mat4 nodeTransform;
+	assimp::CopyMatix(pNode->mTransformation, nodeTransform);
 
 	if (pNodeAnim) {
 		// Interpolate scaling and generate scaling transformation matrix
@@ -278,11 +282,14 @@ void SkinnedMesh::ReadNodeHeirarchy(float animationTime, const aiNode* pNode, co
 		aiVector3D Translation;
 		CalcInterpolatedPosition(Translation, animationTime, pNodeAnim);
 
-		boneT.SetPosition(glm::vec3(Translation.x, Translation.y, Translation.z));
-		boneT.SetRotationAndScale(glm::quat(RotationQ.w, RotationQ.x, RotationQ.y, RotationQ.z), glm::vec3(Scaling.x, Scaling.y, Scaling.z));
+		nodeTransform = glm::toMat4(glm::quat(RotationQ.w, RotationQ.x, RotationQ.y, RotationQ.z));
+		nodeTransform[0] *= Scaling.x;
+		nodeTransform[1] *= Scaling.y;
+		nodeTransform[2] *= Scaling.z;
+		nodeTransform[3] = glm::vec4(Translation.x, Translation.y, Translation.z, 1.0f);
 	}
 
-	glm::mat4 GlobalTransformation = ParentTransform * boneT.model;
+	glm::mat4 GlobalTransformation = ParentTransform * nodeTransform;
 
 	if (skeletalBones.find(NodeName) != skeletalBones.end()) {
 		uint BoneIndex = skeletalBones[NodeName];
@@ -358,8 +365,24 @@ void VertexBoneData::AddBoneData(uint BoneID, float Weight)
 	assert(0);
 }
 
+const vector<glm::mat4>& SkinnedMesh::GetBoneTransforms() const
+{
+	return boneTransform;
+}
+
+unsigned short SkinnedMesh::GetNumberOfBones() const
+{
+	return nrBones;
+}
+
+// Draws outside of a packet write their own palette to the frame ring
 void SkinnedMesh::Render(const Shader *shader)
 {
-	glUniformMatrix4fv(shader->loc_bones[0], nrBones, GL_FALSE, glm::value_ptr(boneTransform[0]));
+	if (shader->loc_bone_offset >= 0 && nrBones) {
+		RingBuffer *ring = Manager::GetRenderSys()->GetFrameData();
+		unsigned int offset = ring->Write(&boneTransform[0], nrBones * sizeof(glm::mat4), sizeof(glm::mat4));
+		if (offset != RingBuffer::INVALID_OFFSET)
+			glUniform1i(shader->loc_bone_offset, offset / sizeof(glm::mat4));
+	}
 	Mesh::Render(shader);
 }
\ No newline at end of file
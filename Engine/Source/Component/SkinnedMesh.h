@@ -62,6 +62,9 @@ class DLLExport SkinnedMesh : public Mesh
 		void SetAnimationState(char *animationState);
 		void ScaleAnimationTime(const string &animation, float timeScale);
 
+		const vector<glm::mat4>& GetBoneTransforms() const;
+		unsigned short GetNumberOfBones() const;
+
 	private:
 		bool InitFromScene(const aiScene* pScene);
 		void InitMesh(const aiMesh* paiMesh, uint index);
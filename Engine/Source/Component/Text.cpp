@@ -27,10 +27,13 @@ Text::Text() {
 	transform = new Transform();
 	transform->scale = glm::vec3(0.005f);
 	transform->Update();
+	buffers = nullptr;
+	nr_indices = 0;
 	atlasTextureID = Manager::Font->atlas->id;
 }
 
 Text::~Text() {
+	SAFE_FREE(buffers);
 }
 
 void Text::SetText(const char *text) {
@@ -44,6 +47,8 @@ void Text::SetOffset(Transform offset) {
 }
 
 void Text::Render(Shader *shader) const {
+	if (!buffers) return;
+
 	glUniformMatrix4fv(shader->loc_model_matrix, 1, GL_FALSE, glm::value_ptr(transform->model));
 
 	glActiveTexture(GL_TEXTURE0);
@@ -120,6 +125,8 @@ void Text::InitText()
 		}
 	}
 
+	// Text can be changed at runtime - release the previous buffers
+	SAFE_FREE(buffers);
 	this->nr_indices = indices.size();
 	buffers = UtilsGPU::UploadData(positions, text_coords, indices);
 }
\ No newline at end of file
@@ -2,7 +2,21 @@
 #include "Transform.h"
 #include <include/math.h>
 
-Transform::Transform() {
+#include <Manager/Manager.h>
+
+#define BIND_STORE(entity)											\
+	entity(Manager::GetComponents()->Create()),						\
+	position(Manager::GetComponents()->Position(entity)),			\
+	rotationQ(Manager::GetComponents()->Rotation(entity)),			\
+	scale(Manager::GetComponents()->Scale(entity)),					\
+	model(Manager::GetComponents()->Model(entity)),					\
+	prevPosition(Manager::GetComponents()->PrevPosition(entity)),	\
+	prevRotationQ(Manager::GetComponents()->PrevRotation(entity)),	\
+	prevScale(Manager::GetComponents()->PrevScale(entity))
+
+Transform::Transform()
+	: BIND_STORE(entity)
+{
 	position = glm::vec3(0);
 	eulerAngles = glm::vec3(0.0f, 0.0f, 0.0f);
 	rotationQ = glm::quat(1.0f, 0, 0, 0);
@@ -13,9 +27,26 @@ Transform::Transform() {
 	scaleSpeed = 0.02f;
 
 	Update();
+	SaveState();
+}
+
+Transform::Transform(const Transform &transform)
+	: BIND_STORE(entity)
+{
+	position = transform.position;
+	rotationQ = transform.rotationQ;
+	eulerAngles = transform.eulerAngles;
+	scale = transform.scale;
+
+	moveSpeed = transform.moveSpeed;
+	rotateSpeed = transform.rotateSpeed;
+	scaleSpeed = transform.scaleSpeed;
+
+	Update();
+	SaveState();
 }
 
-Transform::Transform(const Transform &transform) {
+Transform& Transform::operator=(const Transform &transform) {
 	position = transform.position;
 	rotationQ = transform.rotationQ;
 	eulerAngles = transform.eulerAngles;
@@ -26,89 +57,129 @@ Transform::Transform(const Transform &transform) {
 	scaleSpeed = transform.scaleSpeed;
 
 	Update();
+	return *this;
 }
 
 Transform::~Transform() {
+	Manager::GetComponents()->Destroy(entity);
 }
 
 void Transform::Update() {
-	model = glm::toMat4(rotationQ);
-	model[0] *= scale[0];
-	model[1] *= scale[1];
-	model[2] *= scale[2];
-	UpdatePosition();
+	Manager::GetComponents()->UpdateModel(entity);
+}
+
+void Transform::MarkDirty()
+{
+	Manager::GetComponents()->SetFlags(entity, ENTITY_DIRTY, true);
+}
+
+void Transform::SetParent(Transform *parent)
+{
+	EntityID parentEntity = ComponentStore::NO_PARENT;
+	if (parent)
+		parentEntity = parent->entity;
+	Manager::GetComponents()->SetParent(entity, parentEntity);
 }
 
-void Transform::UpdatePosition()
+EntityID Transform::GetParent() const
 {
-	model[3][0] = position[0];
-	model[3][1] = position[1];
-	model[3][2] = position[2];
+	return Manager::GetComponents()->GetParent(entity);
+}
+
+glm::vec3 Transform::GetWorldPosition() const
+{
+	if (GetParent() == ComponentStore::NO_PARENT)
+		return position;
+
+	glm::mat4 world;
+	Manager::GetComponents()->GetWorldMatrix(entity, world);
+	return glm::vec3(world[3]);
 }
 
 void Transform::Move(const glm::vec3 dir, float deltaTime) {
 	position += glm::normalize(dir) * moveSpeed * deltaTime;
-	Update();
+	MarkDirty();
 }
 
 void Transform::RotateRoll(float deltaTime) {
 	eulerAngles.x += rotateSpeed * deltaTime;
 	rotationQ = glm::quat(eulerAngles);
-	Update();
+	MarkDirty();
 }
 
 void Transform::RotateYaw(float deltaTime) {
 	eulerAngles.y += rotateSpeed * deltaTime;
 	rotationQ = glm::quat(eulerAngles);
-	Update();
+	MarkDirty();
 }
 
 void Transform::RotatePitch(float deltaTime) {
 	eulerAngles.z += rotateSpeed * deltaTime;
 	rotationQ = glm::quat(eulerAngles);
-	Update();
+	MarkDirty();
 }
 
 void Transform::SetPosition(glm::vec3 position)
 {
 	this->position = position;
-	UpdatePosition();
+	MarkDirty();
 }
 
 void Transform::SetRotation(glm::vec3 eulerAngles) {
 	this->eulerAngles = glm::vec3(eulerAngles) * (glm::pi<float>() / 180);
 	rotationQ = glm::quat(this->eulerAngles);
-	Update();
+	MarkDirty();
 }
 
 void Transform::SetRotation(glm::quat roationQ)
 {
 	this->rotationQ = roationQ;
-	Update();
+	MarkDirty();
 }
 
 void Transform::SetRotationAndScale(glm::quat roationQ, glm::vec3 scale)
 {
 	this->rotationQ = roationQ;
 	this->scale = scale;
-	Update();
+	MarkDirty();
 }
 
 void Transform::SetScale(glm::vec3 scale)
 {
 	this->scale = scale;
-	Update();
+	MarkDirty();
 }
 
 void Transform::SetRotationRadians(glm::vec3 eulerAngles) {
 	this->eulerAngles = glm::vec3(eulerAngles);
 	rotationQ = glm::quat(this->eulerAngles);
-	Update();
+	MarkDirty();
 }
 
 void Transform::Scale(float deltaTime) {
 	scale += scaleSpeed * glm::vec3(deltaTime);
-	Update();
+	MarkDirty();
+}
+
+void Transform::SaveState()
+{
+	prevPosition = position;
+	prevRotationQ = rotationQ;
+	prevScale = scale;
+}
+
+void Transform::Interpolate(float alpha)
+{
+	glm::vec3 pos = glm::mix(prevPosition, position, alpha);
+	glm::vec3 scl = glm::mix(prevScale, scale, alpha);
+
+	model = glm::toMat4(glm::slerp(prevRotationQ, rotationQ, alpha));
+	model[0] *= scl[0];
+	model[1] *= scl[1];
+	model[2] *= scl[2];
+	model[3][0] = pos[0];
+	model[3][1] = pos[1];
+	model[3][2] = pos[2];
 }
 
 glm::vec3 Transform::GetRotationVector()
@@ -4,15 +4,31 @@
 #include <include/glm.h>
 
 #include <Core/Object.h>
+#include <Component/ComponentStore.h>
 
+/*
+ *	Facade over an entity of the ComponentStore
+ *	position, rotationQ, scale, model and the previous tick state are references
+ *	into the store - the per-frame systems sweep them without touching the Transform
+ *	Setters only mark the entity dirty, model is rebuilt by the per-frame transform
+ *	pass (ComponentStore::Interpolate) - Update() rebuilds it right away
+ *	GetWorldPosition always reflects the setters, model only after the next pass
+ *	With a parent, position, rotationQ and scale are relative to the parent
+ */
 class DLLExport Transform: virtual public Object 
 {
 	public:
 		Transform();
 		Transform(const Transform &trasform);
+		Transform& operator=(const Transform &transform);
 		virtual ~Transform();
 		void Update();
 
+		// nullptr detaches the transform - the local values are kept
+		void SetParent(Transform *parent);
+		EntityID GetParent() const;
+		glm::vec3 GetWorldPosition() const;
+
 		void Move(const glm::vec3 dir, float deltaTime);
 		void RotateYaw(float deltaTime);
 		void RotatePitch(float deltaTime);
@@ -30,18 +46,30 @@ class DLLExport Transform: virtual public Object
 		void SetScale(glm::vec3 scale);
 		void Scale(float deltaTime);
 
+		// Fixed-timestep interpolation
+		void SaveState();
+		void Interpolate(float alpha);
+
 	private:
-		void UpdatePosition();
+		void MarkDirty();
 
 	// TODO - make them private
 	public:
-		glm::vec3 position;
+		// must be declared before the references bound to it
+		const EntityID entity;
+
+		glm::vec3 &position;
 		// angles in radians
 		glm::vec3 eulerAngles;
 		// rotation quaternion
-		glm::quat rotationQ;
-		glm::vec3 scale;
-		glm::mat4 model;
+		glm::quat &rotationQ;
+		glm::vec3 &scale;
+		glm::mat4 &model;
+
+		// state at the previous simulation tick
+		glm::vec3 &prevPosition;
+		glm::quat &prevRotationQ;
+		glm::vec3 &prevScale;
 
 		float rotateSpeed;	
 		float moveSpeed;
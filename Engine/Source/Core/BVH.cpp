@@ -0,0 +1,385 @@
+//#include <pch.h>
+#include "BVH.h"
+
+#include <cmath>
+
+const float BVH::MARGIN = 0.25f;
+
+static inline float Perimeter(const glm::vec3 &min, const glm::vec3 &max)
+{
+	glm::vec3 d = max - min;
+	return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+static inline bool Contains(const glm::vec3 &outerMin, const glm::vec3 &outerMax, const glm::vec3 &min, const glm::vec3 &max)
+{
+	return outerMin.x <= min.x && outerMin.y <= min.y && outerMin.z <= min.z &&
+		max.x <= outerMax.x && max.y <= outerMax.y && max.z <= outerMax.z;
+}
+
+static inline bool Overlaps(const glm::vec3 &minA, const glm::vec3 &maxA, const glm::vec3 &minB, const glm::vec3 &maxB)
+{
+	return minA.x <= maxB.x && minB.x <= maxA.x &&
+		minA.y <= maxB.y && minB.y <= maxA.y &&
+		minA.z <= maxB.z && minB.z <= maxA.z;
+}
+
+BVH::BVH()
+{
+	root = NULL_NODE;
+	freeList = NULL_NODE;
+	nrLeaves = 0;
+}
+
+BVH::~BVH()
+{
+}
+
+int BVH::AllocateNode()
+{
+	int index;
+	if (freeList != NULL_NODE) {
+		index = freeList;
+		freeList = nodes[index].parent;
+	}
+	else {
+		index = (int)nodes.size();
+		nodes.push_back(Node());
+	}
+
+	Node &node = nodes[index];
+	node.parent = NULL_NODE;
+	node.left = NULL_NODE;
+	node.right = NULL_NODE;
+	node.height = 0;
+	node.obj = nullptr;
+	return index;
+}
+
+void BVH::FreeNode(int index)
+{
+	nodes[index].parent = freeList;
+	nodes[index].height = -1;
+	freeList = index;
+}
+
+int BVH::Insert(GameObject *obj, const glm::vec3 &min, const glm::vec3 &max)
+{
+	int leaf = AllocateNode();
+	nodes[leaf].min = min - glm::vec3(MARGIN);
+	nodes[leaf].max = max + glm::vec3(MARGIN);
+	nodes[leaf].obj = obj;
+	InsertLeaf(leaf);
+	nrLeaves++;
+	return leaf;
+}
+
+void BVH::Remove(int proxy)
+{
+	assert(proxy >= 0 && proxy < (int)nodes.size() && nodes[proxy].IsLeaf());
+	RemoveLeaf(proxy);
+	FreeNode(proxy);
+	nrLeaves--;
+}
+
+bool BVH::Move(int proxy, const glm::vec3 &min, const glm::vec3 &max)
+{
+	Node &node = nodes[proxy];
+	if (Contains(node.min, node.max, min, max))
+		return false;
+
+	RemoveLeaf(proxy);
+	nodes[proxy].min = min - glm::vec3(MARGIN);
+	nodes[proxy].max = max + glm::vec3(MARGIN);
+	InsertLeaf(proxy);
+	return true;
+}
+
+void BVH::Clear()
+{
+	nodes.clear();
+	root = NULL_NODE;
+	freeList = NULL_NODE;
+	nrLeaves = 0;
+}
+
+GameObject* BVH::GetLeaf(int proxy) const
+{
+	return nodes[proxy].obj;
+}
+
+unsigned int BVH::GetSize() const
+{
+	return nrLeaves;
+}
+
+int BVH::GetHeight() const
+{
+	return root == NULL_NODE ? 0 : nodes[root].height;
+}
+
+void BVH::UpdateNode(int index)
+{
+	Node &node = nodes[index];
+	const Node &left = nodes[node.left];
+	const Node &right = nodes[node.right];
+	node.min = glm::min(left.min, right.min);
+	node.max = glm::max(left.max, right.max);
+	node.height = 1 + (left.height > right.height ? left.height : right.height);
+}
+
+void BVH::InsertLeaf(int leaf)
+{
+	if (root == NULL_NODE) {
+		root = leaf;
+		nodes[root].parent = NULL_NODE;
+		return;
+	}
+
+	// Find the best sibling - descend while it is cheaper than pairing with the current node
+	glm::vec3 leafMin = nodes[leaf].min;
+	glm::vec3 leafMax = nodes[leaf].max;
+	int index = root;
+
+	while (!nodes[index].IsLeaf()) {
+		const Node &node = nodes[index];
+		float area = Perimeter(node.min, node.max);
+		float combinedArea = Perimeter(glm::min(node.min, leafMin), glm::max(node.max, leafMax));
+
+		// cost of creating a new parent for this node and the leaf
+		float cost = 2.0f * combinedArea;
+
+		// minimum cost of pushing the leaf further down the tree
+		float inheritanceCost = 2.0f * (combinedArea - area);
+
+		float childCost[2];
+		int children[2] = { node.left, node.right };
+		for (int i = 0; i < 2; i++) {
+			const Node &child = nodes[children[i]];
+			float enlarged = Perimeter(glm::min(child.min, leafMin), glm::max(child.max, leafMax));
+			childCost[i] = (child.IsLeaf() ? enlarged : enlarged - Perimeter(child.min, child.max)) + inheritanceCost;
+		}
+
+		if (cost < childCost[0] && cost < childCost[1])
+			break;
+
+		index = childCost[0] < childCost[1] ? children[0] : children[1];
+	}
+
+	int sibling = index;
+
+	// Create a new parent
+	int oldParent = nodes[sibling].parent;
+	int newParent = AllocateNode();
+	nodes[newParent].parent = oldParent;
+	nodes[newParent].left = sibling;
+	nodes[newParent].right = leaf;
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+
+	if (oldParent != NULL_NODE) {
+		if (nodes[oldParent].left == sibling)
+			nodes[oldParent].left = newParent;
+		else
+			nodes[oldParent].right = newParent;
+	}
+	else {
+		root = newParent;
+	}
+
+	// Walk back up fixing heights and boxes
+	index = newParent;
+	while (index != NULL_NODE) {
+		index = Balance(index);
+		UpdateNode(index);
+		index = nodes[index].parent;
+	}
+}
+
+void BVH::RemoveLeaf(int leaf)
+{
+	if (leaf == root) {
+		root = NULL_NODE;
+		return;
+	}
+
+	int parent = nodes[leaf].parent;
+	int grandParent = nodes[parent].parent;
+	int sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+	if (grandParent != NULL_NODE) {
+		// Connect the sibling to the grand parent and destroy the parent
+		if (nodes[grandParent].left == parent)
+			nodes[grandParent].left = sibling;
+		else
+			nodes[grandParent].right = sibling;
+		nodes[sibling].parent = grandParent;
+		FreeNode(parent);
+
+		int index = grandParent;
+		while (index != NULL_NODE) {
+			index = Balance(index);
+			UpdateNode(index);
+			index = nodes[index].parent;
+		}
+	}
+	else {
+		root = sibling;
+		nodes[sibling].parent = NULL_NODE;
+		FreeNode(parent);
+	}
+}
+
+/*
+ *	Rotate the taller child of A up if the subtree is imbalanced
+ *	Returns the new root of the subtree
+ */
+int BVH::Balance(int iA)
+{
+	Node *A = &nodes[iA];
+	if (A->IsLeaf() || A->height < 2)
+		return iA;
+
+	int iB = A->left;
+	int iC = A->right;
+	Node *B = &nodes[iB];
+	Node *C = &nodes[iC];
+
+	int balance = C->height - B->height;
+
+	// Rotate C up
+	if (balance > 1) {
+		int iF = C->left;
+		int iG = C->right;
+		Node *F = &nodes[iF];
+		Node *G = &nodes[iG];
+
+		// Swap A and C
+		C->left = iA;
+		C->parent = A->parent;
+		A->parent = iC;
+
+		if (C->parent != NULL_NODE) {
+			if (nodes[C->parent].left == iA)
+				nodes[C->parent].left = iC;
+			else
+				nodes[C->parent].right = iC;
+		}
+		else {
+			root = iC;
+		}
+
+		// Keep the taller grand child under C
+		if (F->height > G->height) {
+			C->right = iF;
+			A->right = iG;
+			G->parent = iA;
+		}
+		else {
+			C->right = iG;
+			A->right = iF;
+			F->parent = iA;
+		}
+
+		UpdateNode(iA);
+		UpdateNode(iC);
+		return iC;
+	}
+
+	// Rotate B up
+	if (balance < -1) {
+		int iD = B->left;
+		int iE = B->right;
+		Node *D = &nodes[iD];
+		Node *E = &nodes[iE];
+
+		// Swap A and B
+		B->left = iA;
+		B->parent = A->parent;
+		A->parent = iB;
+
+		if (B->parent != NULL_NODE) {
+			if (nodes[B->parent].left == iA)
+				nodes[B->parent].left = iB;
+			else
+				nodes[B->parent].right = iB;
+		}
+		else {
+			root = iB;
+		}
+
+		// Keep the taller grand child under B
+		if (D->height > E->height) {
+			B->right = iD;
+			A->left = iE;
+			E->parent = iA;
+		}
+		else {
+			B->right = iE;
+			A->left = iD;
+			D->parent = iA;
+		}
+
+		UpdateNode(iA);
+		UpdateNode(iB);
+		return iB;
+	}
+
+	return iA;
+}
+
+void BVH::QueryBox(const glm::vec3 &min, const glm::vec3 &max, vector<GameObject*> &objects) const
+{
+	Query([&min, &max](const glm::vec3 &nodeMin, const glm::vec3 &nodeMax) {
+		return Overlaps(min, max, nodeMin, nodeMax);
+	}, [&objects](GameObject *obj) {
+		objects.push_back(obj);
+	});
+}
+
+void BVH::QuerySphere(const glm::vec3 &center, float radius, vector<GameObject*> &objects) const
+{
+	float radius2 = radius * radius;
+	Query([&center, radius2](const glm::vec3 &nodeMin, const glm::vec3 &nodeMax) {
+		glm::vec3 d = center - glm::clamp(center, nodeMin, nodeMax);
+		return glm::dot(d, d) <= radius2;
+	}, [&objects](GameObject *obj) {
+		objects.push_back(obj);
+	});
+}
+
+void BVH::QueryFrustum(const glm::vec4 planes[6], vector<GameObject*> &objects) const
+{
+	Query([planes](const glm::vec3 &nodeMin, const glm::vec3 &nodeMax) {
+		glm::vec3 center = (nodeMin + nodeMax) * 0.5f;
+		glm::vec3 extent = (nodeMax - nodeMin) * 0.5f;
+		for (int i = 0; i < 6; i++) {
+			glm::vec3 n = glm::vec3(planes[i]);
+			float r = extent.x * fabs(n.x) + extent.y * fabs(n.y) + extent.z * fabs(n.z);
+			if (glm::dot(n, center) + planes[i].w < -r)
+				return false;
+		}
+		return true;
+	}, [&objects](GameObject *obj) {
+		objects.push_back(obj);
+	});
+}
+
+void BVH::QueryRay(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, vector<GameObject*> &objects) const
+{
+	glm::vec3 invDir = 1.0f / direction;
+	Query([&origin, &invDir, maxDistance](const glm::vec3 &nodeMin, const glm::vec3 &nodeMax) {
+		// slab test - IEEE infinities handle the axis parallel directions
+		glm::vec3 t0 = (nodeMin - origin) * invDir;
+		glm::vec3 t1 = (nodeMax - origin) * invDir;
+		glm::vec3 tNear = glm::min(t0, t1);
+		glm::vec3 tFar = glm::max(t0, t1);
+		float enter = tNear.x > tNear.y ? tNear.x : tNear.y;
+		enter = enter > tNear.z ? enter : tNear.z;
+		float exit = tFar.x < tFar.y ? tFar.x : tFar.y;
+		exit = exit < tFar.z ? exit : tFar.z;
+		return enter <= exit && exit >= 0 && enter <= maxDistance;
+	}, [&objects](GameObject *obj) {
+		objects.push_back(obj);
+	});
+}
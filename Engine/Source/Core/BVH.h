@@ -0,0 +1,102 @@
+#pragma once
+#include <cassert>
+#include <vector>
+
+#include <include/dll_export.h>
+#include <include/glm.h>
+
+class GameObject;
+
+using namespace std;
+
+/*
+ *	Dynamic bounding volume hierarchy of world axis boxes
+ *	Leaves store a box enlarged by MARGIN so small moves only refit the leaf
+ *	Inserts pick the sibling with the smallest surface cost and the tree is kept
+ *	balanced with AVL rotations - queries are logarithmic in the number of leaves
+ */
+class DLLExport BVH
+{
+	public:
+		static const int NULL_NODE = -1;
+		static const unsigned int STACK_SIZE = 256;
+		static const float MARGIN;
+
+	public:
+		BVH();
+		~BVH();
+
+		// Returns the proxy identifying the leaf
+		int Insert(GameObject *obj, const glm::vec3 &min, const glm::vec3 &max);
+		void Remove(int proxy);
+
+		// Returns true if the leaf was reinserted (the box left the enlarged box)
+		bool Move(int proxy, const glm::vec3 &min, const glm::vec3 &max);
+		void Clear();
+
+		GameObject* GetLeaf(int proxy) const;
+		unsigned int GetSize() const;
+		int GetHeight() const;
+
+		// Queries append the objects whose enlarged box passes the test
+		void QueryBox(const glm::vec3 &min, const glm::vec3 &max, vector<GameObject*> &objects) const;
+		void QuerySphere(const glm::vec3 &center, float radius, vector<GameObject*> &objects) const;
+		void QueryFrustum(const glm::vec4 planes[6], vector<GameObject*> &objects) const;
+		void QueryRay(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, vector<GameObject*> &objects) const;
+
+		// Generic traversal - test(min, max) culls subtrees, visit(obj) is called for the leaves passing test
+		template <class Test, class Visit>
+		void Query(Test test, Visit visit) const;
+
+	private:
+		struct Node {
+			glm::vec3 min;
+			glm::vec3 max;
+			int parent;			// next free node while in the free list
+			int left;
+			int right;
+			int height;			// 0 for leaves, -1 for free nodes
+			GameObject *obj;
+
+			bool IsLeaf() const { return left == NULL_NODE; };
+		};
+
+		int AllocateNode();
+		void FreeNode(int index);
+		void InsertLeaf(int leaf);
+		void RemoveLeaf(int leaf);
+		void UpdateNode(int index);
+		int Balance(int index);
+
+	private:
+		vector<Node> nodes;
+		int root;
+		int freeList;
+		unsigned int nrLeaves;
+};
+
+template <class Test, class Visit>
+void BVH::Query(Test test, Visit visit) const
+{
+	if (root == NULL_NODE)
+		return;
+
+	int stack[STACK_SIZE];
+	unsigned int top = 0;
+	stack[top++] = root;
+
+	while (top) {
+		const Node &node = nodes[stack[--top]];
+		if (!test(node.min, node.max))
+			continue;
+
+		if (node.IsLeaf()) {
+			visit(node.obj);
+			continue;
+		}
+
+		assert(top + 2 <= STACK_SIZE);
+		stack[top++] = node.left;
+		stack[top++] = node.right;
+	}
+}
@@ -0,0 +1,473 @@
+//#include <pch.h>
+#include "CookedFile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <include/pugixml.h>
+#include <Manager/Profiler.h>
+
+static const unsigned int RECORD_SIZE[CookedFile::TABLE_COUNT] = {
+	sizeof(CookedFile::MeshRecord),
+	sizeof(CookedFile::ObjectRecord),
+	sizeof(CookedFile::AudioRecord),
+	sizeof(CookedFile::EffectRecord),
+	sizeof(CookedFile::InstanceRecord),
+	sizeof(CookedFile::LightRecord),
+	sizeof(CookedFile::CellRecord),
+	sizeof(char)
+};
+
+/*
+ *	Collects the records of an XML description - strings are interned so
+ *	repeated names (refIDs, paths) are stored once
+ */
+struct CookedBuilder
+{
+	vector<CookedFile::MeshRecord> meshes;
+	vector<CookedFile::ObjectRecord> objects;
+	vector<CookedFile::AudioRecord> audio;
+	vector<CookedFile::EffectRecord> effects;
+	vector<CookedFile::InstanceRecord> instances;
+	vector<CookedFile::LightRecord> lights;
+	vector<CookedFile::CellRecord> cells;
+	vector<char> strings;
+	float cellSize;
+	float loadRadius;
+	float unloadRadius;
+	unordered_map<string, unsigned int> interned;
+
+	unsigned int AddString(const char *value)
+	{
+		auto entry = interned.find(value);
+		if (entry != interned.end())
+			return entry->second;
+
+		unsigned int offset = (unsigned int)strings.size();
+		strings.insert(strings.end(), value, value + strlen(value) + 1);
+		interned[value] = offset;
+		return offset;
+	}
+
+	// Value of a child node or NO_STRING if the node is missing
+	unsigned int AddChild(pugi::xml_node node, const char *name)
+	{
+		pugi::xml_node child = node.child(name);
+		return child ? AddString(child.text().get()) : CookedFile::NO_STRING;
+	}
+};
+
+// Same rules as glm::ExtractVector - a single value is used for all the components
+static void ReadVector(const char *text, float *vec)
+{
+	char *end;
+	unsigned int i = 0;
+	for (; i < 3; i++) {
+		vec[i] = strtof(text, &end);
+		if (end == text)
+			break;
+		text = end;
+	}
+	for (unsigned int k = i; k < 3; k++)
+		vec[k] = i ? vec[0] : 0;
+}
+
+static void ReadTransform(pugi::xml_node node, CookedFile::TransformRecord &record)
+{
+	memset(&record, 0, sizeof(record));
+	if (!node)
+		return;
+
+	pugi::xml_node prop;
+	prop = node.child("position");
+	if (prop) {
+		record.fields |= CookedFile::FIELD_POSITION;
+		ReadVector(prop.text().get(), record.position);
+	}
+
+	prop = node.child("rotation");
+	if (prop) {
+		record.fields |= CookedFile::FIELD_ROTATION;
+		ReadVector(prop.text().get(), record.rotation);
+	}
+
+	prop = node.child("scale");
+	if (prop) {
+		record.fields |= CookedFile::FIELD_SCALE;
+		ReadVector(prop.text().get(), record.scale);
+	}
+}
+
+static void CookResources(const pugi::xml_document &doc, CookedBuilder &builder)
+{
+	for (pugi::xml_node mesh : doc.child("meshes").children()) {
+		CookedFile::MeshRecord record;
+		record.name = builder.AddString(mesh.child_value("name"));
+		record.path = builder.AddString(mesh.child_value("path"));
+		record.file = builder.AddString(mesh.child_value("file"));
+		record.flags = 0;
+		if (mesh.attribute("skinned").as_bool())
+			record.flags |= CookedFile::FLAG_SKINNED;
+		if (mesh.attribute("quad").as_bool())
+			record.flags |= CookedFile::FLAG_QUAD;
+		if (mesh.attribute("material"))
+			record.flags |= CookedFile::FLAG_NO_MATERIAL;
+		if (mesh.attribute("stream").as_bool())
+			record.flags |= CookedFile::FLAG_STREAMED;
+		builder.meshes.push_back(record);
+	}
+
+	for (pugi::xml_node obj : doc.child("objects").children()) {
+		CookedFile::ObjectRecord record;
+		record.name = builder.AddString(obj.child_value("name"));
+		record.mesh = builder.AddChild(obj, "mesh");
+		record.shader = builder.AddChild(obj, "shader");
+		pugi::xml_node physics = obj.child("physics");
+		record.physics = physics ? builder.AddString(physics.child_value("file")) : CookedFile::NO_STRING;
+		record.flags = 0;
+		if (obj.child("shadow"))
+			record.flags |= CookedFile::FLAG_SHADOW;
+		if (obj.child("static").text().as_bool())
+			record.flags |= CookedFile::FLAG_STATIC;
+		if (obj.child("occluder").text().as_bool())
+			record.flags |= CookedFile::FLAG_OCCLUDER;
+		ReadTransform(obj.child("transform"), record.transform);
+		builder.objects.push_back(record);
+	}
+
+	for (pugi::xml_node audio : doc.child("audio").children()) {
+		CookedFile::AudioRecord record;
+		record.name = builder.AddString(audio.child_value("name"));
+		record.path = builder.AddString(audio.child_value("path"));
+		record.file = builder.AddString(audio.child_value("file"));
+		record.flags = 0;
+		if (strcmp(audio.name(), "music") == 0)
+			record.flags |= CookedFile::FLAG_MUSIC;
+		if (strcmp(audio.name(), "soundfx") == 0)
+			record.flags |= CookedFile::FLAG_SOUND_FX;
+
+		record.firstEffect = (unsigned int)builder.effects.size();
+		for (pugi::xml_node fx : audio.child("effects").children()) {
+			CookedFile::EffectRecord effect;
+			effect.name = builder.AddString(fx.child_value("name"));
+			effect.start = fx.child("start").text().as_float();
+			effect.end = fx.child("end").text().as_float();
+			builder.effects.push_back(effect);
+		}
+		record.nrEffects = (unsigned int)builder.effects.size() - record.firstEffect;
+		builder.audio.push_back(record);
+	}
+}
+
+// Sort the instances by grid cell and build the cell table
+static void PartitionScene(CookedBuilder &builder)
+{
+	vector<pair<pair<int, int>, unsigned int>> order;
+	for (unsigned int i = 0; i < builder.instances.size(); i++) {
+		const CookedFile::TransformRecord &T = builder.instances[i].transform;
+		int x = 0, z = 0;
+		if (T.fields & CookedFile::FIELD_POSITION) {
+			x = (int)floor(T.position[0] / builder.cellSize);
+			z = (int)floor(T.position[2] / builder.cellSize);
+		}
+		order.push_back(make_pair(make_pair(x, z), i));
+	}
+	stable_sort(order.begin(), order.end());
+
+	vector<CookedFile::InstanceRecord> sorted;
+	for (auto &entry : order) {
+		if (builder.cells.empty() || builder.cells.back().x != entry.first.first || builder.cells.back().z != entry.first.second) {
+			CookedFile::CellRecord cell;
+			cell.x = entry.first.first;
+			cell.z = entry.first.second;
+			cell.firstInstance = (unsigned int)sorted.size();
+			cell.nrInstances = 0;
+			builder.cells.push_back(cell);
+		}
+		builder.cells.back().nrInstances++;
+		sorted.push_back(builder.instances[entry.second]);
+	}
+	builder.instances.swap(sorted);
+}
+
+static void CookScene(const pugi::xml_document &doc, CookedBuilder &builder)
+{
+	pugi::xml_node objects = doc.child("objects");
+	builder.cellSize = objects.attribute("cell-size").as_float();
+	builder.loadRadius = objects.attribute("load-radius").as_float(2 * builder.cellSize);
+	builder.unloadRadius = objects.attribute("unload-radius").as_float(builder.loadRadius + builder.cellSize);
+
+	for (pugi::xml_node obj : objects.children()) {
+		CookedFile::InstanceRecord record;
+		record.ref = builder.AddString(obj.child_value("ref"));
+		record.audio = CookedFile::NO_STRING;
+		record.flags = 0;
+		record.volume = 0;
+
+		pugi::xml_node audio = obj.child("audio");
+		if (audio) {
+			record.audio = builder.AddString(audio.text().get());
+			if (audio.attribute("loop").as_bool())
+				record.flags |= CookedFile::FLAG_AUDIO_LOOP;
+			pugi::xml_attribute volume = audio.attribute("volume");
+			if (!volume.empty()) {
+				record.flags |= CookedFile::FLAG_AUDIO_VOLUME;
+				record.volume = volume.as_float();
+			}
+		}
+
+		pugi::xml_node staticInfo = obj.child("static");
+		if (staticInfo) {
+			record.flags |= CookedFile::FLAG_HAS_STATIC;
+			if (staticInfo.text().as_bool())
+				record.flags |= CookedFile::FLAG_STATIC;
+		}
+
+		ReadTransform(obj.child("transform"), record.transform);
+		builder.instances.push_back(record);
+	}
+
+	for (pugi::xml_node light : doc.child("lights").children()) {
+		CookedFile::LightRecord record;
+		record.area = light.child("area").text().as_float();
+		ReadTransform(light.child("transform"), record.transform);
+		builder.lights.push_back(record);
+	}
+
+	if (builder.cellSize > 0)
+		PartitionScene(builder);
+}
+
+template <class T>
+static void AppendTable(vector<char> &blob, CookedFile::TableInfo &info, const vector<T> &records)
+{
+	info.offset = (unsigned int)blob.size();
+	info.count = (unsigned int)records.size();
+	if (records.size()) {
+		const char *begin = reinterpret_cast<const char*>(records.data());
+		blob.insert(blob.end(), begin, begin + records.size() * sizeof(T));
+	}
+}
+
+CookedFile::CookedFile()
+{
+}
+
+CookedFile::~CookedFile()
+{
+}
+
+string CookedFile::GetCookedName(const char *xmlFile)
+{
+	string name = xmlFile;
+	size_t extension = name.find_last_of('.');
+	if (extension != string::npos && name.find_first_of("/\\", extension) == string::npos)
+		name.erase(extension);
+	return name + ".bin";
+}
+
+bool CookedFile::Build(const char *xmlFile, FileType type, vector<char> &blob)
+{
+	PROFILE_SCOPE("Cook");
+
+	struct stat source;
+	pugi::xml_document doc;
+	if (stat(xmlFile, &source) != 0 || !doc.load_file(xmlFile)) {
+		cout << "Error: could not cook => '" << xmlFile << "'" << endl;
+		return false;
+	}
+
+	CookedBuilder builder;
+	builder.cellSize = 0;
+	builder.loadRadius = 0;
+	builder.unloadRadius = 0;
+	if (type == RESOURCES)
+		CookResources(doc, builder);
+	else
+		CookScene(doc, builder);
+
+	Header header;
+	memset(&header, 0, sizeof(header));
+	header.magic = MAGIC;
+	header.version = VERSION;
+	header.type = type;
+	header.sourceSize = (unsigned int)source.st_size;
+	header.sourceTime = (unsigned long long)source.st_mtime;
+	header.cellSize = builder.cellSize;
+	header.loadRadius = builder.loadRadius;
+	header.unloadRadius = builder.unloadRadius;
+
+	blob.assign(sizeof(Header), 0);
+	AppendTable(blob, header.tables[TABLE_MESHES], builder.meshes);
+	AppendTable(blob, header.tables[TABLE_OBJECTS], builder.objects);
+	AppendTable(blob, header.tables[TABLE_AUDIO], builder.audio);
+	AppendTable(blob, header.tables[TABLE_EFFECTS], builder.effects);
+	AppendTable(blob, header.tables[TABLE_INSTANCES], builder.instances);
+	AppendTable(blob, header.tables[TABLE_LIGHTS], builder.lights);
+	AppendTable(blob, header.tables[TABLE_CELLS], builder.cells);
+	AppendTable(blob, header.tables[TABLE_STRINGS], builder.strings);
+	memcpy(blob.data(), &header, sizeof(header));
+	return true;
+}
+
+bool CookedFile::Cook(const char *xmlFile, const char *cookedFile, FileType type)
+{
+	vector<char> blob;
+	if (!Build(xmlFile, type, blob))
+		return false;
+
+	FILE *file = fopen(cookedFile, "wb");
+	if (!file) {
+		cout << "Error: could not write => '" << cookedFile << "'" << endl;
+		return false;
+	}
+	bool written = fwrite(blob.data(), 1, blob.size(), file) == blob.size();
+	fclose(file);
+	return written;
+}
+
+bool CookedFile::Load(const char *xmlFile, FileType type)
+{
+	PROFILE_SCOPE("Load Cooked");
+
+	string cookedName = GetCookedName(xmlFile);
+	struct stat source;
+	bool hasSource = stat(xmlFile, &source) == 0;
+
+	if (Read(cookedName.c_str(), type)) {
+		const Header *header = reinterpret_cast<const Header*>(data.data());
+		if (!hasSource || (header->sourceSize == (unsigned int)source.st_size &&
+			header->sourceTime == (unsigned long long)source.st_mtime))
+			return true;
+	}
+
+	// Missing or out of date - cook the XML and keep the result for the next run
+	if (!Build(xmlFile, type, data))
+		return false;
+
+	FILE *file = fopen(cookedName.c_str(), "wb");
+	if (file) {
+		fwrite(data.data(), 1, data.size(), file);
+		fclose(file);
+	}
+	else {
+		cout << "Warning: could not write => '" << cookedName << "'" << endl;
+	}
+	return true;
+}
+
+bool CookedFile::Read(const char *fileName, FileType type)
+{
+	data.clear();
+	FILE *file = fopen(fileName, "rb");
+	if (!file)
+		return false;
+
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	bool read = false;
+	if (size > 0) {
+		data.resize(size);
+		read = fread(data.data(), 1, size, file) == (size_t)size;
+	}
+	fclose(file);
+
+	if (!read || !Validate(type)) {
+		data.clear();
+		return false;
+	}
+	return true;
+}
+
+// Optional fields are NO_STRING when the XML node was missing
+static bool ValidString(unsigned int offset, unsigned int nrChars, bool optional = false)
+{
+	return offset < nrChars || (optional && offset == CookedFile::NO_STRING);
+}
+
+bool CookedFile::Validate(FileType type) const
+{
+	if (data.size() < sizeof(Header))
+		return false;
+
+	const Header *header = reinterpret_cast<const Header*>(data.data());
+	if (header->magic != MAGIC || header->version != VERSION || header->type != (unsigned int)type)
+		return false;
+
+	for (unsigned int i = 0; i < TABLE_COUNT; i++) {
+		const TableInfo &info = header->tables[i];
+		if (info.offset > data.size() || info.count > (data.size() - info.offset) / RECORD_SIZE[i])
+			return false;
+	}
+
+	// cells must stay inside the instance table
+	const TableInfo &cells = header->tables[TABLE_CELLS];
+	const CellRecord *cell = reinterpret_cast<const CellRecord*>(data.data() + cells.offset);
+	for (unsigned int i = 0; i < cells.count; i++, cell++) {
+		if (cell->firstInstance > header->tables[TABLE_INSTANCES].count ||
+			cell->nrInstances > header->tables[TABLE_INSTANCES].count - cell->firstInstance)
+			return false;
+	}
+
+	// strings must be terminated
+	const TableInfo &strings = header->tables[TABLE_STRINGS];
+	if (strings.count && data[strings.offset + strings.count - 1] != 0)
+		return false;
+
+	// and every offset must be inside the table - GetString callers only expect NO_STRING
+	unsigned int count;
+	unsigned int n = strings.count;
+	auto meshes = GetTable<MeshRecord>(TABLE_MESHES, count);
+	for (unsigned int i = 0; i < count; i++) {
+		if (!ValidString(meshes[i].name, n) || !ValidString(meshes[i].path, n) || !ValidString(meshes[i].file, n))
+			return false;
+	}
+
+	auto objects = GetTable<ObjectRecord>(TABLE_OBJECTS, count);
+	for (unsigned int i = 0; i < count; i++) {
+		if (!ValidString(objects[i].name, n) || !ValidString(objects[i].mesh, n, true) ||
+			!ValidString(objects[i].shader, n, true) || !ValidString(objects[i].physics, n, true))
+			return false;
+	}
+
+	auto audio = GetTable<AudioRecord>(TABLE_AUDIO, count);
+	for (unsigned int i = 0; i < count; i++) {
+		if (!ValidString(audio[i].name, n) || !ValidString(audio[i].path, n) || !ValidString(audio[i].file, n))
+			return false;
+	}
+
+	auto effects = GetTable<EffectRecord>(TABLE_EFFECTS, count);
+	for (unsigned int i = 0; i < count; i++) {
+		if (!ValidString(effects[i].name, n))
+			return false;
+	}
+
+	auto instances = GetTable<InstanceRecord>(TABLE_INSTANCES, count);
+	for (unsigned int i = 0; i < count; i++) {
+		if (!ValidString(instances[i].ref, n) || !ValidString(instances[i].audio, n, true))
+			return false;
+	}
+	return true;
+}
+
+const CookedFile::Header* CookedFile::GetHeader() const
+{
+	return reinterpret_cast<const Header*>(data.data());
+}
+
+const char* CookedFile::GetString(unsigned int offset) const
+{
+	if (offset == NO_STRING)
+		return nullptr;
+	const TableInfo &strings = reinterpret_cast<const Header*>(data.data())->tables[TABLE_STRINGS];
+	return offset < strings.count ? data.data() + strings.offset + offset : nullptr;
+}
@@ -0,0 +1,179 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include <include/dll_export.h>
+
+using namespace std;
+
+/*
+ *	Binary form of the XML scene and resource descriptions
+ *	The blob is a header, tables of fixed size records and a string table - records
+ *	refer to strings by offset, so after a single read (or a file mapping) the data
+ *	is used in place without any parsing
+ *	XML stays the authoring format: Load cooks the XML file again when the blob is
+ *	missing, was written by another version or its source file has changed
+ *	Scenes with a cell-size attribute on <objects> have their instances sorted by
+ *	grid cell, with a cell table for streaming (see WorldPartition)
+ */
+class DLLExport CookedFile
+{
+	public:
+		static const unsigned int MAGIC = 0x4B4F4F43;		// "COOK"
+		static const unsigned int VERSION = 4;
+		static const unsigned int NO_STRING = 0xFFFFFFFF;
+
+		enum FileType {
+			RESOURCES = 1,
+			SCENE = 2
+		};
+
+		enum Table {
+			TABLE_MESHES,
+			TABLE_OBJECTS,
+			TABLE_AUDIO,
+			TABLE_EFFECTS,
+			TABLE_INSTANCES,
+			TABLE_LIGHTS,
+			TABLE_CELLS,
+			TABLE_STRINGS,
+			TABLE_COUNT
+		};
+
+		enum RecordFlags {
+			FLAG_SKINNED		= 1 << 0,
+			FLAG_QUAD			= 1 << 1,
+			FLAG_NO_MATERIAL	= 1 << 2,
+			FLAG_SHADOW			= 1 << 3,
+			FLAG_STATIC			= 1 << 4,
+			FLAG_HAS_STATIC		= 1 << 5,	// scene entry overrides the resource classification
+			FLAG_MUSIC			= 1 << 6,
+			FLAG_SOUND_FX		= 1 << 7,
+			FLAG_AUDIO_LOOP		= 1 << 8,
+			FLAG_AUDIO_VOLUME	= 1 << 9,
+			FLAG_OCCLUDER		= 1 << 10,
+			FLAG_STREAMED		= 1 << 11
+		};
+
+		enum TransformFields {
+			FIELD_POSITION	= 1 << 0,
+			FIELD_ROTATION	= 1 << 1,
+			FIELD_SCALE		= 1 << 2
+		};
+
+		struct TableInfo {
+			unsigned int offset;
+			unsigned int count;
+		};
+
+		struct Header {
+			unsigned int magic;
+			unsigned int version;
+			unsigned int type;
+			unsigned int sourceSize;
+			unsigned long long sourceTime;
+
+			// scene partition - no cells when cellSize is 0
+			float cellSize;
+			float loadRadius;
+			float unloadRadius;
+			unsigned int padding;
+
+			TableInfo tables[TABLE_COUNT];
+		};
+
+		// Only the fields given in the XML are applied - rotation is in degrees
+		struct TransformRecord {
+			unsigned int fields;
+			float position[3];
+			float rotation[3];
+			float scale[3];
+		};
+
+		struct MeshRecord {
+			unsigned int name;
+			unsigned int path;
+			unsigned int file;
+			unsigned int flags;
+		};
+
+		struct ObjectRecord {
+			unsigned int name;
+			unsigned int mesh;
+			unsigned int shader;
+			unsigned int physics;
+			unsigned int flags;
+			TransformRecord transform;
+		};
+
+		struct AudioRecord {
+			unsigned int name;
+			unsigned int path;
+			unsigned int file;
+			unsigned int flags;
+			unsigned int firstEffect;
+			unsigned int nrEffects;
+		};
+
+		struct EffectRecord {
+			unsigned int name;
+			float start;
+			float end;
+		};
+
+		// Scene object - an instance of a resource object
+		struct InstanceRecord {
+			unsigned int ref;
+			unsigned int audio;
+			unsigned int flags;
+			float volume;
+			TransformRecord transform;
+		};
+
+		struct LightRecord {
+			float area;
+			TransformRecord transform;
+		};
+
+		// Range of the instance table inside a grid cell (on the XZ plane)
+		struct CellRecord {
+			int x;
+			int z;
+			unsigned int firstInstance;
+			unsigned int nrInstances;
+		};
+
+	public:
+		CookedFile();
+		~CookedFile();
+
+		// Read the cooked form of xmlFile, cooking it first if it is out of date
+		bool Load(const char *xmlFile, FileType type);
+
+		// Compile an XML description into a cooked file
+		static bool Cook(const char *xmlFile, const char *cookedFile, FileType type);
+		static string GetCookedName(const char *xmlFile);
+
+		template <class T>
+		const T* GetTable(Table table, unsigned int &count) const;
+		const Header* GetHeader() const;
+
+		// nullptr for NO_STRING
+		const char* GetString(unsigned int offset) const;
+
+	private:
+		static bool Build(const char *xmlFile, FileType type, vector<char> &blob);
+		bool Read(const char *fileName, FileType type);
+		bool Validate(FileType type) const;
+
+	private:
+		vector<char> data;
+};
+
+template <class T>
+const T* CookedFile::GetTable(Table table, unsigned int &count) const
+{
+	const TableInfo &info = reinterpret_cast<const Header*>(data.data())->tables[table];
+	count = info.count;
+	return count ? reinterpret_cast<const T*>(data.data() + info.offset) : nullptr;
+}
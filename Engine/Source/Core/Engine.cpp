@@ -1,17 +1,47 @@
 //#include <pch.h>
 #include "Engine.h"
+
+#include <chrono>
+
 #include <Core/InputSystem.h>
 #include <Core/WindowManager.h>
+#include <Manager/Manager.h>
+#include <Manager/JobSystem.h>
+#include <Manager/Profiler.h>
+#include <Manager/RenderingSystem.h>
+#include <Manager/SceneManager.h>
+#include <Rendering/RenderPacket.h>
 
 // Engine
 double Engine::elapsedTime = 0;
 double Engine::deltaTime = 0;
 bool Engine::paused = false;
 World* Engine::world = nullptr;
+double Engine::fixedDeltaTime = 1.0 / 60;
+double Engine::maxFrameTime = 0.25;
+double Engine::accumulator = 0;
+double Engine::simulationTime = 0;
+float Engine::interpolation = 1.0f;
+RenderPacket Engine::packets[2];
+RenderPacket* Engine::simulationPacket = &Engine::packets[0];
+RenderPacket* Engine::renderPacket = &Engine::packets[1];
+unsigned int Engine::frameID = 0;
+unsigned int Engine::renderedFrameID = 0;
+bool Engine::pipelined = false;
+bool Engine::headless = false;
+bool Engine::closeRequested = false;
+unsigned int Engine::headlessFrames = 0;
 WindowObject* Engine::Window = nullptr;
 
 /* Get elapsed time in seconds from when engine start */
 void Engine::ComputeFrameDeltaTime() {
+	// Simulated clock - every headless frame advances exactly one tick, unthrottled
+	if (headless) {
+		deltaTime = fixedDeltaTime;
+		elapsedTime += deltaTime;
+		return;
+	}
+
 	static double lastTime = glfwGetTime() - 60.0/1000;
 
 	elapsedTime = glfwGetTime();
@@ -23,37 +53,215 @@ void Engine::SetWorldInstance(World *world_instance) {
 	world = world_instance;
 }
 
+void Engine::SetFixedTimeStep(unsigned int ticksPerSecond) {
+	if (ticksPerSecond == 0) return;
+	fixedDeltaTime = 1.0 / ticksPerSecond;
+	accumulator = 0;
+}
+
+/*
+ * Pipelined mode simulates frame N+1 on a job while the main thread submits frame N
+ * World::FixedUpdate and World::Extract must not issue GL calls in this mode
+ * Havok may be used from the job - HavokCore initializes it on every worker thread
+ */
+void Engine::SetPipelined(bool value) {
+	pipelined = value;
+	cout << "PIPELINED FRAMES: " << pipelined << endl;
+}
+
+/*
+ * Headless mode runs without a window or GL context
+ * Only the simulation and extraction stages are executed
+ * maxFrames = 0 runs until Exit is called
+ */
+void Engine::SetHeadless(bool value, unsigned int maxFrames) {
+	headless = value;
+	headlessFrames = maxFrames;
+	if (headless)
+		cout << "HEADLESS: frame limit " << maxFrames << endl;
+}
+
+bool Engine::IsHeadless() {
+	return headless;
+}
+
+/* Time in seconds at the start of the current frame */
+double Engine::GetElapsedTime() {
+	return elapsedTime;
+}
+
+double Engine::GetFixedDeltaTime() {
+	return fixedDeltaTime;
+}
+
+/* Fraction of a simulation tick elapsed since the last FixedUpdate [0, 1) */
+float Engine::GetInterpolationFactor() {
+	return interpolation;
+}
+
+unsigned int Engine::GetFrameID() {
+	return frameID;
+}
+
+unsigned int Engine::GetRenderedFrameID() {
+	return renderedFrameID;
+}
+
 void Engine::Run() {
 
+	auto startTime = chrono::steady_clock::now();
+
 	/* Loop until the user closes the window */
-	while (!glfwWindowShouldClose(Window->window)) {
+	while (!ShouldClose()) {
 		Update();
 	}
 
+	if (headless) {
+		double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+		printf("HEADLESS: %u frames in %.3lf s (%.3lf ms/frame)\n", frameID, seconds, frameID ? seconds * 1000 / frameID : 0);
+	}
+
 	Exit();
 }
 
+bool Engine::ShouldClose() {
+	if (headless)
+		return closeRequested || (headlessFrames && frameID >= headlessFrames);
+	return glfwWindowShouldClose(Window->window) != 0;
+}
+
 void Engine::Update()
 {
+	if (headless) {
+		#ifdef ENGINE_PROFILER
+		Manager::GetProfiler()->BeginFrame();
+		#endif
+
+		ComputeFrameDeltaTime();
+		Simulate();
+
+		// Nothing is rendered - packets are done once extracted
+		renderedFrameID = frameID;
+		if (world)
+			world->Update((float)elapsedTime, (float)deltaTime);
+		InputSystem::EndFrame();
+
+		#ifdef ENGINE_PROFILER
+		Manager::GetProfiler()->EndFrame();
+		#endif
+		return;
+	}
+
 	/* Poll and process events */
 	glfwPollEvents();
 
 	ComputeFrameDeltaTime();
 	if (paused) return;
 
-	/* Clear previous frame */
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	#ifdef ENGINE_PROFILER
+	Manager::GetProfiler()->BeginFrame();
+	#endif
+
+	Manager::GetRenderSys()->BeginFrame();
+
+	if (pipelined) {
+		/* Submit the previous packet while the next one is simulated */
+		JobHandle simulation = Manager::GetJobs()->Schedule("Simulate Job", Simulate);
+		SubmitFrame();
+		{
+			PROFILE_SCOPE("Wait Simulation");
+			Manager::GetJobs()->Wait(simulation);
+		}
 
-	/* Render Frame */
-	if (world)
-		world->Update((float)elapsedTime, (float)deltaTime);
+		if (world) {
+			PROFILE_SCOPE("Update");
+			world->Update((float)elapsedTime, (float)deltaTime);
+		}
+
+		swap(simulationPacket, renderPacket);
+	}
+	else {
+		Simulate();
+
+		if (world) {
+			PROFILE_SCOPE("Update");
+			world->Update((float)elapsedTime, (float)deltaTime);
+		}
+
+		swap(simulationPacket, renderPacket);
+		SubmitFrame();
+	}
 
 	InputSystem::EndFrame();
+	Manager::GetRenderSys()->EndFrame();
 
 	/* Swap front and back buffers */
-	if (!paused)
+	if (!paused) {
+		PROFILE_SCOPE("Swap Buffers");
 		glfwSwapBuffers(Window->window);
+	}
+
+	#ifdef ENGINE_PROFILER
+	Manager::GetProfiler()->EndFrame();
+	#endif
+}
+
+void Engine::FixedUpdate()
+{
+	PROFILE_SCOPE("Fixed Update");
+
+	// Clamp long frames (breakpoints, loading hitches) so the simulation
+	// doesn't try to catch up with an unbounded number of ticks
+	accumulator += deltaTime < maxFrameTime ? deltaTime : maxFrameTime;
+
+	while (accumulator >= fixedDeltaTime) {
+		Manager::GetScene()->SaveState();
+
+		if (world)
+			world->FixedUpdate((float)simulationTime, (float)fixedDeltaTime);
+
+		simulationTime += fixedDeltaTime;
+		accumulator -= fixedDeltaTime;
+	}
+
+	interpolation = float(accumulator / fixedDeltaTime);
+}
+
+/* Advance the simulation and capture its render state */
+void Engine::Simulate()
+{
+	PROFILE_SCOPE("Simulate");
 
+	FixedUpdate();
+
+	/* Blend transforms between the last two simulation ticks */
+	Manager::GetScene()->InterpolateState(interpolation);
+
+	simulationPacket->Clear();
+	simulationPacket->frameID = ++frameID;
+	simulationPacket->elapsedTime = (float)elapsedTime;
+	simulationPacket->deltaTime = (float)deltaTime;
+
+	if (world) {
+		PROFILE_SCOPE("Extract");
+		world->Extract(*simulationPacket);
+	}
+}
+
+void Engine::SubmitFrame()
+{
+	PROFILE_SCOPE("Render");
+	PROFILE_GPU_SCOPE("Frame");
+
+	/* Clear previous frame */
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	/* Nothing was extracted yet on the first pipelined frame */
+	if (world && renderPacket->frameID) {
+		renderPacket->UploadBones();
+		world->Render(*renderPacket);
+		renderedFrameID = renderPacket->frameID;
+	}
 }
 
 void Engine::Pause() {
@@ -62,12 +270,15 @@ void Engine::Pause() {
 }
 
 void Engine::Exit() {
-	if (!glfwWindowShouldClose(Window->window)) {
-		glfwSetWindowShouldClose(Window->window, 1);
+	if (!ShouldClose()) {
+		closeRequested = true;
+		if (!headless)
+			glfwSetWindowShouldClose(Window->window, 1);
 		return;
 	}
 	cout << "=====================================================" << endl;
 	cout << "Engine closed. Exit" << endl;
+	Manager::GetJobs()->Shutdown();
 	glfwTerminate();
 }
 
@@ -9,6 +9,8 @@
 #include <Core/WindowObject.h>
 #include <Core/World.h>
 
+class RenderPacket;
+
 using namespace std;
 
 /*
@@ -21,6 +23,21 @@ class DLLExport Engine {
 		static void Pause();
 		static void Exit();
 		static void SetWorldInstance(World *world);
+		static void SetFixedTimeStep(unsigned int ticksPerSecond);
+		static void SetPipelined(bool value);
+		static void SetHeadless(bool value, unsigned int maxFrames = 0);
+
+		static bool IsHeadless();
+		static double GetElapsedTime();
+
+		static double GetFixedDeltaTime();
+		static float GetInterpolationFactor();
+
+		// Last packet extracted by the simulation and last packet submitted - data the
+		// render stage reads through a packet may be freed once GetRenderedFrameID
+		// reaches the GetFrameID of the moment it was dropped
+		static unsigned int GetFrameID();
+		static unsigned int GetRenderedFrameID();
 
 	public:
 		static WindowObject *Window;
@@ -28,10 +45,35 @@ class DLLExport Engine {
 	private:
 		static void Update();
 		static void ComputeFrameDeltaTime();
+		static void FixedUpdate();
+		static void Simulate();
+		static void SubmitFrame();
+		static bool ShouldClose();
 
 	private:
 		static double elapsedTime;
 		static double deltaTime;
+
+		// Fixed-timestep simulation state
+		static double fixedDeltaTime;
+		static double maxFrameTime;
+		static double accumulator;
+		static double simulationTime;
+		static float interpolation;
+
+		// Simulation writes one packet while the render stage consumes the other
+		static RenderPacket packets[2];
+		static RenderPacket *simulationPacket;
+		static RenderPacket *renderPacket;
+		static unsigned int frameID;
+		static unsigned int renderedFrameID;
+		static bool pipelined;
+
+		// Headless mode - no window or GL context, simulation only
+		static bool headless;
+		static bool closeRequested;
+		static unsigned int headlessFrames;
+
 		static bool paused;
 		static World *world;
 };
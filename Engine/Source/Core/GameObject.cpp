@@ -3,10 +3,12 @@
 
 #include <Component/AudioSource.h>
 #include <Component/AABB.h>
+#include <Component/ComponentStore.h>
 #include <Component/Mesh.h>
 #include <Component/Renderer.h>
 #include <Component/Transform.h>
 #include <Component/ObjectInput.h>
+#include <Core/BVH.h>
 #include <GPU/Shader.h>
 
 #include <Manager/DebugInfo.h>
@@ -23,7 +25,7 @@ GameObject::GameObject(const char *name)
 {
 	Clear();
 	if (name) {
-		refID = new char[strlen(name)];
+		refID = new char[strlen(name) + 1];
 		refID = strcpy(refID, name);
 	}
 	renderer = new Renderer();
@@ -34,6 +36,8 @@ GameObject::GameObject(const char *name)
 GameObject::GameObject(const GameObject &obj) {
 	Clear();
 	refID	= obj.refID;
+	staticObject = obj.staticObject;
+	occluder = obj.occluder;
 	mesh	= obj.mesh;
 	shader	= obj.shader;
 	input	= obj.input;
@@ -62,6 +66,12 @@ void GameObject::Clear() {
 	renderer = nullptr;
 	shader = nullptr;
 	transform = nullptr;
+	sceneHandle = SlotHandle();
+	spatialProxy = BVH::NULL_NODE;
+	staticObject = false;
+	occluder = false;
+	pooled = false;
+	lod = 0;
 	#ifdef PHYSICS_ENGINE
 	physics = nullptr;
 	#endif
@@ -128,10 +138,24 @@ void GameObject::SetDebugView(bool value) {
 	debugView ? Manager::Debug->Add(this) : Manager::Debug->Remove(this);
 }
 
+// Sources are shared streams owned by the AudioManager - a replaced one is only stopped
 void GameObject::SetAudioSource(AudioSource *source)
 {
+	if (audioSource && audioSource != source)
+		audioSource->Stop();
 	audioSource = source;
-	audioSource->SetPosition(transform->position);
+	if (audioSource)
+		audioSource->SetPosition(transform->position);
+}
+
+void GameObject::SetParent(GameObject *parent)
+{
+	transform->SetParent(parent ? parent->transform : nullptr);
+}
+
+EntityID GameObject::GetEntity() const
+{
+	return transform->entity;
 }
 
 float GameObject::DistTo(GameObject *object)
@@ -140,3 +164,33 @@ float GameObject::DistTo(GameObject *object)
 	float d2 = (d.x * d.x) + (d.y * d.y) + (d.z * d.z);
 	return sqrt(d2);
 }
+
+SlotHandle GameObject::GetSceneHandle() const
+{
+	return sceneHandle;
+}
+
+bool GameObject::IsStatic() const
+{
+	return staticObject;
+}
+
+bool GameObject::IsOccluder() const
+{
+	return occluder;
+}
+
+unsigned int GameObject::UpdateLOD(const glm::vec3 &eye, float projectionScale)
+{
+	if (!mesh || !aabb || mesh->GetLODCount() < 2)
+		return 0;
+
+	glm::vec3 min, max;
+	Manager::GetComponents()->GetWorldBounds(aabb->transform->entity, min, max);
+	float radius = glm::length(max - min) * 0.5f;
+	float distance = glm::distance(eye, (min + max) * 0.5f);
+
+	float screenSize = distance > radius ? radius * projectionScale / distance : 1;
+	lod = mesh->SelectLOD(screenSize, lod);
+	return lod;
+}
@@ -2,8 +2,10 @@
 
 #include <include/glm.h>
 #include <include/dll_export.h>
+#include <templates/slot_map.h>
 
 #include <Core/Object.h>
+#include <Component/ComponentStore.h>
 
 class AABB;
 class AudioSource;
@@ -19,6 +21,7 @@ using namespace std;
 class DLLExport GameObject: virtual public Object
 {
 	friend class SceneManager;
+	friend class ResourceManager;
 
 	public:
 		GameObject(const char *name);
@@ -39,6 +42,25 @@ class DLLExport GameObject: virtual public Object
 		void SetDebugView(bool value);
 		void SetAudioSource(AudioSource *source);
 
+		// Attach the transform to the parent's one - nullptr detaches it
+		void SetParent(GameObject *parent);
+
+		// Entity of the transform - the per-frame data lives in the ComponentStore
+		EntityID GetEntity() const;
+
+		// Handle into the scene active objects - invalid while not in the scene
+		SlotHandle GetSceneHandle() const;
+
+		// Static objects are skipped by the per-frame BVH refit (see SceneManager::SetStatic)
+		bool IsStatic() const;
+
+		// Occluders are rasterized into the CPU depth buffer of the occlusion culling
+		bool IsOccluder() const;
+
+		// Mesh level from the projected size of the bounding sphere - projectionScale is Projection[1][1]
+		// The chosen level is kept for the hysteresis of the next selection
+		unsigned int UpdateLOD(const glm::vec3 &eye, float projectionScale);
+
 		virtual void Update();
 		virtual void UseShader(Shader *shader);
 
@@ -60,6 +82,12 @@ class DLLExport GameObject: virtual public Object
 		char *refID;
 		unsigned int instanceID;
 		bool debugView;
+		SlotHandle sceneHandle;
+		int spatialProxy;
+		bool staticObject;
+		bool occluder;
+		bool pooled;
+		unsigned int lod;
 };
 
 // TODO idea
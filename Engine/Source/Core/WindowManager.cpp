@@ -17,6 +17,17 @@ WindowObject* WindowManager::NewWindow(char* name, glm::ivec2 resolution, glm::i
 	return W;
 }
 
+// Window description without a GLFW window or GL context
+WindowObject* WindowManager::NewHeadlessWindow(char* name, glm::ivec2 resolution)
+{
+	WindowObject *W = new WindowObject();
+	W->Init(name, resolution, glm::ivec2(0), false);
+	W->window = nullptr;
+
+	windows->push_back(W);
+	return W;
+}
+
 void WindowManager::Init() {
 	Manager::Debug->InitManager("WindowManager");
 	WindowManager::windows = new vector<WindowObject*>;
@@ -16,6 +16,7 @@ class WindowManager
 		static void Init();
 		static void OnResize(GLFWwindow *W, int width, int height);
 		static WindowObject* NewWindow(char* name, glm::ivec2 resolution, glm::ivec2 position, bool reshapable);
+		static WindowObject* NewHeadlessWindow(char* name, glm::ivec2 resolution);
 		static WindowObject* GetWindowObject(GLFWwindow *W);
 
 	private:
@@ -1,9 +1,23 @@
 #pragma once
 
+class RenderPacket;
+
 class World {
 	public:
 		World() {};
 		virtual ~World() {};
 		virtual void Init() {};
+
+		// Simulation tick - called at the fixed rate set by Engine::SetFixedTimeStep
+		virtual void FixedUpdate(float elapsed_time, float delta_time) {};
+
+		// Per-frame stage on the main thread - may access live scene state
+		// The simulation is idle and, except in headless mode, the GL context is current
 		virtual void Update(float elapsed_time, float delta_time) {};
+
+		// Capture everything the render stage needs - runs right after the simulation
+		virtual void Extract(RenderPacket &packet) {};
+
+		// Submit a packet produced by Extract - must not touch simulated state
+		virtual void Render(const RenderPacket &packet) {};
 };
\ No newline at end of file
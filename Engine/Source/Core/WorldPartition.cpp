@@ -0,0 +1,300 @@
+//#include <pch.h>
+#include "WorldPartition.h"
+
+#include <algorithm>
+
+#include <Component/Mesh.h>
+#include <Core/Engine.h>
+#include <Core/GameObject.h>
+
+#include <Manager/Manager.h>
+#include <Manager/Profiler.h>
+#include <Manager/ResourceManager.h>
+#include <Manager/SceneManager.h>
+
+// Streamed meshes uploaded per Update - each one creates its buffers and textures
+static const unsigned int MESH_UPLOADS_PER_UPDATE = 2;
+
+WorldPartition::WorldPartition()
+{
+	scene = nullptr;
+	cellSize = 0;
+	loadRadius = 0;
+	unloadRadius = 0;
+	budget = 32;
+}
+
+WorldPartition::~WorldPartition()
+{
+}
+
+void WorldPartition::Init(const CookedFile *scene)
+{
+	Clear();
+
+	const CookedFile::Header *header = scene->GetHeader();
+	this->scene = scene;
+	cellSize = header->cellSize;
+	loadRadius = header->loadRadius;
+	unloadRadius = header->unloadRadius > loadRadius ? header->unloadRadius : loadRadius;
+
+	// Jobs keep a pointer to their cell - the vector is not resized until Clear
+	unsigned int count;
+	auto records = scene->GetTable<CookedFile::CellRecord>(CookedFile::TABLE_CELLS, count);
+	cells.resize(count);
+	for (unsigned int i = 0; i < count; i++) {
+		Cell &cell = cells[i];
+		cell.x = records[i].x;
+		cell.z = records[i].z;
+		cell.firstInstance = records[i].firstInstance;
+		cell.nrInstances = records[i].nrInstances;
+		cell.state = CELL_UNLOADED;
+		cell.wanted = false;
+	}
+}
+
+void WorldPartition::Clear()
+{
+	for (auto &cell : cells) {
+		if (cell.job) {
+			Manager::GetJobs()->Wait(cell.job);
+			cell.job = nullptr;
+		}
+		Unload(cell);
+	}
+	cells.clear();
+	scene = nullptr;
+}
+
+bool WorldPartition::IsEnabled() const
+{
+	return scene && cellSize > 0;
+}
+
+void WorldPartition::SetBudget(unsigned int objectsPerUpdate)
+{
+	budget = objectsPerUpdate;
+}
+
+unsigned int WorldPartition::GetActiveCells() const
+{
+	unsigned int count = 0;
+	for (auto &cell : cells)
+		count += cell.state == CELL_ACTIVE ? 1 : 0;
+	return count;
+}
+
+// Distance on the XZ plane from the viewer to the cell rectangle
+float WorldPartition::GetDistance(const Cell &cell, const glm::vec3 &viewer) const
+{
+	float minX = cell.x * cellSize;
+	float minZ = cell.z * cellSize;
+	float dx = viewer.x < minX ? minX - viewer.x : viewer.x - (minX + cellSize);
+	float dz = viewer.z < minZ ? minZ - viewer.z : viewer.z - (minZ + cellSize);
+	dx = dx > 0 ? dx : 0;
+	dz = dz > 0 ? dz : 0;
+	return sqrt(dx * dx + dz * dz);
+}
+
+void WorldPartition::Update(const glm::vec3 &viewer)
+{
+	EvictMeshes();
+
+	if (!IsEnabled())
+		return;
+
+	PROFILE_SCOPE("World Partition");
+	unsigned int remaining = budget;
+	unsigned int uploads = MESH_UPLOADS_PER_UPDATE;
+
+	for (auto &cell : cells) {
+		float distance = GetDistance(cell, viewer);
+		if (distance <= loadRadius)
+			cell.wanted = true;
+		else if (distance > unloadRadius)
+			cell.wanted = false;
+
+		switch (cell.state) {
+			case CELL_UNLOADED:
+				if (cell.wanted)
+					Request(cell);
+				break;
+
+			case CELL_LOADING:
+				if (!cell.job->IsDone())
+					break;
+				cell.job = nullptr;
+				if (!cell.wanted) {
+					Unload(cell);
+					break;
+				}
+				// Held until the cell is unloaded - released meshes may be evicted
+				for (auto mesh : cell.meshes)
+					mesh->Acquire();
+				cell.state = CELL_SPAWNING;
+				// fall through
+
+			case CELL_SPAWNING:
+				if (!cell.wanted) {
+					Unload(cell);
+					break;
+				}
+				if (UploadMeshes(cell, uploads))
+					Spawn(cell, remaining);
+				break;
+
+			case CELL_ACTIVE:
+				if (!cell.wanted)
+					Unload(cell);
+				break;
+		}
+	}
+}
+
+// Resolve the cell records and import its streamed meshes on a worker
+// Meshes another job already imports are left to it - UploadMeshes waits for them
+void WorldPartition::Request(Cell &cell)
+{
+	cell.state = CELL_LOADING;
+	cell.records.clear();
+	cell.meshes.clear();
+
+	Cell *target = &cell;
+	const CookedFile *file = scene;
+	cell.job = Manager::GetJobs()->Schedule("Load Cell", [target, file]() {
+		unsigned int count;
+		auto instances = file->GetTable<CookedFile::InstanceRecord>(CookedFile::TABLE_INSTANCES, count);
+
+		target->records.reserve(target->nrInstances);
+		for (unsigned int i = target->firstInstance; i < target->firstInstance + target->nrInstances; i++) {
+			const GameObject *prefab = Manager::GetResource()->GetPrefab(file->GetString(instances[i].ref));
+			if (!prefab) {
+				cout << "Error: Resource game-object not found => '" << file->GetString(instances[i].ref) << "'" << endl;
+				continue;
+			}
+			target->records.push_back(i);
+
+			Mesh *mesh = prefab->mesh;
+			if (mesh && mesh->IsStreamed() && find(target->meshes.begin(), target->meshes.end(), mesh) == target->meshes.end())
+				target->meshes.push_back(mesh);
+		}
+
+		for (auto mesh : target->meshes) {
+			if (mesh->BeginImport())
+				mesh->Import();
+		}
+	});
+}
+
+// True once all streamed meshes of the cell are resident
+// A mesh evicted between the job and the Acquire is imported again by a new job
+bool WorldPartition::UploadMeshes(Cell &cell, unsigned int &uploads)
+{
+	bool resident = true;
+	for (auto mesh : cell.meshes) {
+		switch (mesh->GetResidency()) {
+			case MeshResidency::UNLOADED:
+				if (mesh->BeginImport())
+					Manager::GetJobs()->Schedule("Import Mesh", [mesh]() { mesh->Import(); });
+				resident = false;
+				break;
+
+			case MeshResidency::IMPORTING:
+				resident = false;
+				break;
+
+			case MeshResidency::IMPORTED:
+				if (!uploads) {
+					resident = false;
+					break;
+				}
+				mesh->Upload();
+				uploads--;
+				break;
+
+			default:
+				break;
+		}
+	}
+	return resident;
+}
+
+void WorldPartition::Spawn(Cell &cell, unsigned int &remaining)
+{
+	unsigned int count;
+	auto instances = scene->GetTable<CookedFile::InstanceRecord>(CookedFile::TABLE_INSTANCES, count);
+
+	while (remaining && cell.objects.size() < cell.records.size()) {
+		GameObject *obj = Manager::GetScene()->SpawnInstance(*scene, instances[cell.records[cell.objects.size()]]);
+		cell.objects.push_back(obj);
+		remaining--;
+	}
+
+	if (cell.objects.size() < cell.records.size())
+		return;
+
+	// The whole cell becomes active at once
+	for (auto obj : cell.objects) {
+		if (obj)
+			Manager::GetScene()->AddObject(obj);
+	}
+	cell.state = CELL_ACTIVE;
+}
+
+void WorldPartition::Unload(Cell &cell)
+{
+	// A running job is left to finish - its result is dropped when polled
+	if (cell.state == CELL_LOADING && cell.job) {
+		cell.wanted = false;
+		return;
+	}
+
+	for (auto obj : cell.objects) {
+		if (!obj)
+			continue;
+		if (cell.state == CELL_ACTIVE)
+			Manager::GetScene()->RemoveObject(obj);
+		Manager::GetResource()->Release(obj);
+	}
+
+	// The packet extracted last may still draw the cell objects
+	if (cell.state == CELL_SPAWNING || cell.state == CELL_ACTIVE) {
+		for (auto mesh : cell.meshes) {
+			mesh->Release();
+			if (mesh->GetUsers())
+				continue;
+
+			auto retired = find_if(retiredMeshes.begin(), retiredMeshes.end(), [mesh](const RetiredMesh &entry) { return entry.mesh == mesh; });
+			if (retired == retiredMeshes.end()) {
+				RetiredMesh entry;
+				entry.mesh = mesh;
+				retiredMeshes.push_back(entry);
+				retired = retiredMeshes.end() - 1;
+			}
+			retired->frameID = Engine::GetFrameID();
+		}
+	}
+
+	cell.objects.clear();
+	cell.records.clear();
+	cell.meshes.clear();
+	cell.state = CELL_UNLOADED;
+}
+
+// Meshes acquired again meanwhile stay resident
+void WorldPartition::EvictMeshes()
+{
+	unsigned int rendered = Engine::GetRenderedFrameID();
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < retiredMeshes.size(); i++) {
+		RetiredMesh &retired = retiredMeshes[i];
+		if (retired.mesh->GetUsers())
+			continue;
+		if (retired.frameID > rendered) {
+			retiredMeshes[count++] = retired;
+			continue;
+		}
+		retired.mesh->Evict();
+	}
+	retiredMeshes.resize(count);
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <vector>
+
+#include <include/dll_export.h>
+#include <include/glm.h>
+
+#include <Core/CookedFile.h>
+#include <Manager/JobSystem.h>
+
+class GameObject;
+class Mesh;
+
+using namespace std;
+
+/*
+ *	Streams the grid cells of a cooked scene around a viewer
+ *	A cell is requested when the viewer comes within loadRadius of it and dropped once
+ *	the viewer is farther than unloadRadius, so cells on the border do not thrash
+ *	Requested cells are resolved by a background job, which also imports the streamed
+ *	meshes of the cell (see Mesh::SetStreamed) - the main thread uploads them, then
+ *	creates the objects (a budget per update) which enter the scene together once all
+ *	of them are ready - unloaded objects go back to the prefab pools and streamed
+ *	meshes no other cell uses are evicted once the packets drawing them were rendered
+ *	Update runs per frame on the main thread, while the simulation is idle
+ */
+class DLLExport WorldPartition
+{
+	public:
+		enum CellState {
+			CELL_UNLOADED,
+			CELL_LOADING,		// background job resolving the records and importing meshes
+			CELL_SPAWNING,		// meshes uploaded, then objects created on the main thread
+			CELL_ACTIVE
+		};
+
+	public:
+		WorldPartition();
+		~WorldPartition();
+
+		// The cooked scene must stay loaded while the partition is in use
+		void Init(const CookedFile *scene);
+		void Clear();
+		bool IsEnabled() const;
+
+		// Objects created per Update - the rest of a cell waits for the next ones
+		void SetBudget(unsigned int objectsPerUpdate);
+		void Update(const glm::vec3 &viewer);
+
+		unsigned int GetActiveCells() const;
+
+	private:
+		struct Cell {
+			int x;
+			int z;
+			unsigned int firstInstance;
+			unsigned int nrInstances;
+			CellState state;
+			bool wanted;
+			JobHandle job;
+			vector<unsigned int> records;		// instances with a resident prefab - written by the job
+			vector<Mesh*> meshes;				// streamed meshes of the prefabs - written by the job
+			vector<GameObject*> objects;
+		};
+
+		float GetDistance(const Cell &cell, const glm::vec3 &viewer) const;
+		void Request(Cell &cell);
+		bool UploadMeshes(Cell &cell, unsigned int &uploads);
+		void Spawn(Cell &cell, unsigned int &remaining);
+		void Unload(Cell &cell);
+		void EvictMeshes();
+
+	private:
+		const CookedFile *scene;
+		float cellSize;
+		float loadRadius;
+		float unloadRadius;
+		unsigned int budget;
+		vector<Cell> cells;
+
+		// Meshes without users - frameID is the last packet that may still draw them
+		struct RetiredMesh {
+			Mesh *mesh;
+			unsigned int frameID;
+		};
+		vector<RetiredMesh> retiredMeshes;
+};
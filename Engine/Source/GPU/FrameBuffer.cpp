@@ -37,6 +37,9 @@ void FrameBuffer::Generate(int width, int height, int nrTextures) {
 	this->height = height;
 	this->nrTextures = nrTextures;
 
+	if (Engine::IsHeadless())
+		return;
+
 	// Create FrameBufferObject
 	glGenFramebuffers (1, &FBO);
 	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
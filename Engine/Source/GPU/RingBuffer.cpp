@@ -0,0 +1,185 @@
+//#include <pch.h>
+#include "RingBuffer.h"
+
+#include <cstring>
+
+// Nanoseconds waited per glClientWaitSync before flushing again
+static const GLuint64 FENCE_TIMEOUT = 1000000;
+
+RingBuffer::RingBuffer()
+{
+	buffer = 0;
+	texture = 0;
+	mapped = nullptr;
+	persistent = false;
+	frameSize = 0;
+	requestedSize = 0;
+	maxFrameSize = 0;
+	uniformAlignment = 256;
+	region = 0;
+	offset = 0;
+	stalls = 0;
+	for (unsigned int i = 0; i < FRAMES; i++)
+		fences[i] = 0;
+}
+
+RingBuffer::~RingBuffer()
+{
+	Destroy();
+}
+
+void RingBuffer::Init(unsigned int frameSize)
+{
+	requestedSize = frameSize;
+}
+
+void RingBuffer::Create()
+{
+	GLint value = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &value);
+	uniformAlignment = value > 0 ? (unsigned int)value : 256;
+
+	// The buffer texture must address every region
+	glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &value);
+	maxFrameSize = (unsigned int)value / FRAMES * 16 / uniformAlignment * uniformAlignment;
+	frameSize = (requestedSize + uniformAlignment - 1) / uniformAlignment * uniformAlignment;
+	frameSize = frameSize < maxFrameSize ? frameSize : maxFrameSize;
+
+	GLsizeiptr size = (GLsizeiptr)frameSize * FRAMES;
+	persistent = GLEW_ARB_buffer_storage != 0;
+
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+	if (persistent) {
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_TEXTURE_BUFFER, size, nullptr, flags);
+		mapped = (unsigned char*)glMapBufferRange(GL_TEXTURE_BUFFER, 0, size, flags);
+		persistent = mapped != nullptr;
+	}
+	if (!persistent)
+		glBufferData(GL_TEXTURE_BUFFER, size, nullptr, GL_STREAM_DRAW);
+
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_BUFFER, texture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buffer);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void RingBuffer::Destroy()
+{
+	for (unsigned int i = 0; i < FRAMES; i++) {
+		if (fences[i])
+			glDeleteSync(fences[i]);
+		fences[i] = 0;
+	}
+	if (texture)
+		glDeleteTextures(1, &texture);
+	if (buffer) {
+		if (mapped) {
+			glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+			glUnmapBuffer(GL_TEXTURE_BUFFER);
+			glBindBuffer(GL_TEXTURE_BUFFER, 0);
+		}
+		glDeleteBuffers(1, &buffer);
+	}
+	texture = 0;
+	buffer = 0;
+	mapped = nullptr;
+}
+
+void RingBuffer::WaitFence(unsigned int region)
+{
+	if (!fences[region])
+		return;
+
+	GLenum result = glClientWaitSync(fences[region], 0, 0);
+	if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) {
+		stalls++;
+		do {
+			result = glClientWaitSync(fences[region], GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT);
+		} while (result == GL_TIMEOUT_EXPIRED);
+	}
+
+	glDeleteSync(fences[region]);
+	fences[region] = 0;
+}
+
+void RingBuffer::BeginFrame()
+{
+	// Regions are resized once the GPU is done with all of them
+	if (buffer && requestedSize > frameSize && frameSize < maxFrameSize) {
+		for (unsigned int i = 0; i < FRAMES; i++)
+			WaitFence(i);
+		Destroy();
+	}
+	if (!buffer)
+		Create();
+
+	region = (region + 1) % FRAMES;
+	offset = 0;
+	WaitFence(region);
+}
+
+void RingBuffer::EndFrame()
+{
+	if (!buffer)
+		return;
+	if (fences[region])
+		glDeleteSync(fences[region]);
+	fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+unsigned int RingBuffer::Write(const void *data, unsigned int size, unsigned int alignment)
+{
+	if (!buffer)
+		return INVALID_OFFSET;
+
+	// Offsets are aligned in the whole buffer - alignment may not divide the region size
+	unsigned int base = region * frameSize;
+	unsigned int start = (base + offset + alignment - 1) / alignment * alignment;
+	unsigned int end = start + size - base;
+	if (end > frameSize) {
+		requestedSize = end * 2 > requestedSize ? end * 2 : requestedSize;
+		return INVALID_OFFSET;
+	}
+
+	if (persistent) {
+		memcpy(mapped + start, data, size);
+	}
+	else {
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, start, size, data);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+
+	offset = end;
+	return start;
+}
+
+void RingBuffer::BindRange(GLenum target, GLuint index, unsigned int offset, unsigned int size) const
+{
+	glBindBufferRange(target, index, buffer, offset, size);
+}
+
+void RingBuffer::BindTexture(GLenum textureUnit) const
+{
+	glActiveTexture(textureUnit);
+	glBindTexture(GL_TEXTURE_BUFFER, texture);
+	glActiveTexture(GL_TEXTURE0);
+}
+
+unsigned int RingBuffer::GetUniformAlignment() const
+{
+	return uniformAlignment;
+}
+
+bool RingBuffer::IsPersistent() const
+{
+	return persistent;
+}
+
+unsigned int RingBuffer::GetStalls() const
+{
+	return stalls;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <include/dll_export.h>
+#include <include/gl.h>
+
+using namespace std;
+
+/*
+ *	Per-frame GPU data written once by the CPU and referenced by offset
+ *	The buffer is split in FRAMES regions - a frame allocates linearly from its region
+ *	and a fence guards the region until the GPU has consumed that frame, so writes
+ *	never stall on draws still in flight
+ *	With ARB_buffer_storage the buffer stays persistently mapped, otherwise the
+ *	writes go through glBufferSubData
+ *	The whole buffer is also exposed as a RGBA32F buffer texture
+ */
+class DLLExport RingBuffer
+{
+	public:
+		static const unsigned int FRAMES = 3;
+		static const unsigned int INVALID_OFFSET = 0xFFFFFFFF;
+
+	public:
+		RingBuffer();
+		~RingBuffer();
+
+		// GL objects are created by the first BeginFrame
+		void Init(unsigned int frameSize);
+
+		void BeginFrame();
+		void EndFrame();
+
+		// Byte offset of the copy, a multiple of alignment - INVALID_OFFSET once the
+		// region of the frame is full (the next frames get a larger region)
+		unsigned int Write(const void *data, unsigned int size, unsigned int alignment);
+
+		void BindRange(GLenum target, GLuint index, unsigned int offset, unsigned int size) const;
+		void BindTexture(GLenum textureUnit) const;
+
+		unsigned int GetUniformAlignment() const;
+		bool IsPersistent() const;
+
+		// Frames that had to wait for the GPU to release their region
+		unsigned int GetStalls() const;
+
+	private:
+		void Create();
+		void Destroy();
+		void WaitFence(unsigned int region);
+
+	private:
+		GLuint buffer;
+		GLuint texture;
+		unsigned char *mapped;
+		bool persistent;
+
+		unsigned int frameSize;
+		unsigned int requestedSize;
+		unsigned int maxFrameSize;
+		unsigned int uniformAlignment;
+
+		unsigned int region;
+		unsigned int offset;
+		GLsync fences[FRAMES];
+		unsigned int stalls;
+};
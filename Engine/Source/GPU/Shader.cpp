@@ -1,6 +1,9 @@
 //#include <pch.h>
 #include "Shader.h"
 
+#include <Core/Engine.h>
+#include <Manager/Profiler.h>
+
 
 Shader::Shader() {
 	program = 0;
@@ -9,7 +12,8 @@ Shader::Shader() {
 
 Shader::~Shader()
 {
-	glDeleteProgram(program);
+	if (program)
+		glDeleteProgram(program);
 }
 
 void Shader::BindTexturesUnits() {
@@ -20,6 +24,10 @@ void Shader::BindTexturesUnits() {
 		if (loc_cube_textures[i] >= 0)
 			glUniform1i(loc_cube_textures[i], i);
 	}
+	if (loc_instance_data >= 0)
+		glUniform1i(loc_instance_data, FRAME_TEXTURE_UNIT);
+	if (loc_bone_data >= 0)
+		glUniform1i(loc_bone_data, FRAME_TEXTURE_UNIT);
 }
 
 void Shader::GetUniforms() {
@@ -43,6 +51,8 @@ void Shader::GetUniforms() {
 
 	loc_shadowID = glGetUniformLocation(program, "shadowID");
 	loc_shadow_texel_size = glGetUniformLocation(program, "shadow_texel_size");
+	loc_cube_views = glGetUniformLocation(program, "CubeView");
+	loc_face_mask = glGetUniformLocation(program, "face_mask");
 
 	// Camera
 	loc_eye_pos = glGetUniformLocation(program, "eye_position");
@@ -69,14 +79,16 @@ void Shader::GetUniforms() {
 	// Material Block
 	loc_material = glGetUniformBlockIndex(program, "Material");	
 
-	char buffer[64];
+	// Frame Block
+	loc_frame_data = glGetUniformBlockIndex(program, "FrameData");
+	if (loc_frame_data != INVALID_LOC)
+		glUniformBlockBinding(program, loc_frame_data, FRAME_DATA_BINDING);
 
 	// Skinning data
-	for (unsigned int i = 0; i < MAX_BONES; i++) {
-		memset(buffer, 0, sizeof(buffer));
-		sprintf_s(buffer, "Bones[%d]", i);
-		loc_bones[i] = glGetUniformLocation(program, buffer);
-	}
+	loc_bone_offset = glGetUniformLocation(program, "bone_offset");
+	loc_bone_data = glGetUniformLocation(program, "bone_data");
+
+	char buffer[64];
 
 	// Textures
 	for (int i = 0; i < MAX_2D_TEXTURES; i++) {
@@ -88,6 +100,11 @@ void Shader::GetUniforms() {
 	}
 	loc_channel_mask = glGetUniformLocation(program, "channel_mask");
 
+	// Instancing
+	loc_instanced = glGetUniformLocation(program, "instanced");
+	loc_instance_offset = glGetUniformLocation(program, "instance_offset");
+	loc_instance_data = glGetUniformLocation(program, "instance_data");
+
 	// Text
 	text_color = glGetUniformLocation(program, "text_color");	
 	
@@ -109,6 +126,12 @@ void Shader::SetShaderFiles(vector <string> shaderFiles)
 }
 
 void Shader::Reload() {
+	// Shaders are only parsed from the config - nothing to compile for
+	if (Engine::IsHeadless())
+		return;
+
+	PROFILE_SCOPE("Compile Shader");
+
 	if (program)
 		glDeleteProgram(program);
 
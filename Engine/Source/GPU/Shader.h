@@ -7,8 +7,9 @@
 #include <include/gl.h>
 
 #define MAX_2D_TEXTURES 16
-#define MAX_BONES		100
 #define INVALID_LOC -1
+#define FRAME_TEXTURE_UNIT 15		// frame ring buffer texture - instances and bone palettes
+#define FRAME_DATA_BINDING 1
 
 using namespace std;
 
@@ -35,6 +36,7 @@ class DLLExport Shader
 		GLint loc_textures[MAX_2D_TEXTURES];
 		GLint loc_cube_textures[MAX_2D_TEXTURES];
 		GLint loc_material;
+		GLint loc_frame_data;
 		GLint loc_channel_mask;
 
 		// MVP
@@ -49,6 +51,8 @@ class DLLExport Shader
 		GLint loc_light_view_matrix;
 		GLint loc_light_projection_matrix;
 		GLint loc_shadow_texel_size;
+		GLint loc_cube_views;
+		GLint loc_face_mask;
 
 		// Cascaded shadow mapping
 		GLint CSM_LightView;
@@ -82,7 +86,13 @@ class DLLExport Shader
 		GLint active_shadow;
 
 		// Skinning
-		GLint loc_bones[MAX_BONES];
+		GLint loc_bone_offset;
+		GLint loc_bone_data;
+
+		// Instancing
+		GLint loc_instanced;
+		GLint loc_instance_offset;
+		GLint loc_instance_data;
 
 		// Text
 		GLint text_color;
@@ -1,6 +1,8 @@
 //#include <pch.h>
 #include "Texture.h"
 
+#include <Core/Engine.h>
+
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image/stb_image.h>
 
@@ -16,9 +18,13 @@ Texture::Texture() {
 	width = 0;
 	height = 0;
 	textureID = 0;
+	pixels = nullptr;
+	channels = 0;
 }
 
 Texture::~Texture() {
+	if (pixels)
+		stbi_image_free(pixels);
 }
 
 GLuint Texture::GetTextureID()
@@ -28,6 +34,15 @@ GLuint Texture::GetTextureID()
 
 bool Texture::Load2D(const char* file_name, GLenum wrapping_mode)
 {
+	return Decode(file_name) && Upload(wrapping_mode);
+}
+
+bool Texture::Decode(const char* file_name)
+{
+	// No GPU to upload to - skip decoding as well
+	if (Engine::IsHeadless())
+		return true;
+
 	int width, height, chn;
 	unsigned char *data = stbi_load(file_name, &width, &height, &chn, 0);
 
@@ -43,20 +58,39 @@ bool Texture::Load2D(const char* file_name, GLenum wrapping_mode)
 	cout << width << " * " << height << " channels: " << chn << endl << endl;
 	#endif
 
+	if (pixels)
+		stbi_image_free(pixels);
+	pixels = data;
+	channels = chn;
+	this->width = width;
+	this->height = height;
+	return true;
+}
+
+bool Texture::Upload(GLenum wrapping_mode)
+{
+	if (Engine::IsHeadless())
+		return true;
+
+	if (!pixels)
+		return false;
+
 	Init2DTexture(width, height);
 
 	SetParameters(GL_LINEAR, GL_LINEAR, wrapping_mode);
-	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat[0][chn], width, height, 0, pixelFormat[chn], GL_UNSIGNED_BYTE, (void*)data);
+	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat[0][channels], width, height, 0, pixelFormat[channels], GL_UNSIGNED_BYTE, (void*)pixels);
 	glGenerateMipmap(GL_TEXTURE_2D);
 
 	glBindTexture(GL_TEXTURE_2D, 0);
 
-	stbi_image_free(data);
+	stbi_image_free(pixels);
+	pixels = nullptr;
 	return true;
 }
 
 void Texture::Create2DTexture(const unsigned char* img, int width, int height, int chn) {
-	Init2DTexture(width, height);
+	if (!Init2DTexture(width, height))
+		return;
 
 	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat[0][chn], width, height, 0, pixelFormat[chn], GL_UNSIGNED_BYTE, (void*)img);
 	CheckOpenGLError();
@@ -66,7 +100,8 @@ void Texture::Create2DTexture(const unsigned char* img, int width, int height, i
 
 void Texture::Create2DTexture(const unsigned short* img, int width, int height, int chn)
 {
-	Init2DTexture(width, height);
+	if (!Init2DTexture(width, height))
+		return;
 
 	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat[1][chn], width, height, 0, pixelFormat[chn], GL_UNSIGNED_SHORT, (void*)img);
 	CheckOpenGLError();
@@ -78,7 +113,8 @@ void Texture::Create2DTextureFloat(const float* data, int width, int height, int
 {
 	int prec = precision == 32 ? 3 : 2;
 
-	Init2DTexture(width, height);
+	if (!Init2DTexture(width, height))
+		return;
 
 	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat[prec][chn], width, height, 0, pixelFormat[chn], GL_FLOAT, (void*)data);
 
@@ -91,6 +127,9 @@ void Texture::CreateCubeTexture(const float* data, int width, int height, int ch
 	this->width = width;
 	this->height = height;
 
+	if (Engine::IsHeadless())
+		return;
+
 	glDeleteTextures(1, &textureID);
 	glGenTextures(1, &textureID);
 	glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
@@ -113,7 +152,8 @@ void Texture::CreateCubeTexture(const float* data, int width, int height, int ch
 
 void Texture::CreateFrameBufferTexture(int width, int height, int targetID)
 {
-	Init2DTexture(width, height);
+	if (!Init2DTexture(width, height))
+		return;
 
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, 0);
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + targetID, GL_TEXTURE_2D, textureID, 0);
@@ -124,7 +164,8 @@ void Texture::CreateFrameBufferTexture(int width, int height, int targetID)
 
 void Texture::CreateDepthBufferTexture(int width, int height)
 {
-	Init2DTexture(width, height);
+	if (!Init2DTexture(width, height))
+		return;
 
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, 0);
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, textureID, 0);
@@ -133,6 +174,32 @@ void Texture::CreateDepthBufferTexture(int width, int height)
 	glBindTexture(GL_TEXTURE_2D, 0);
 }
 
+// Layered depth attachment for rendering all the cube faces in one pass
+void Texture::CreateCubeDepthTexture(int width, int height)
+{
+	this->width = width;
+	this->height = height;
+
+	if (Engine::IsHeadless())
+		return;
+
+	glDeleteTextures(1, &textureID);
+	glGenTextures(1, &textureID);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+	for (int i = 0; i < 6; i++) {
+		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_DEPTH_COMPONENT24, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+	}
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, textureID, 0);
+
+	CheckOpenGLError();
+	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+}
 
 void Texture::Bind(GLenum TextureUnit) const
 {
@@ -148,6 +215,13 @@ void Texture::BindForWriting(GLenum textureTarget) const
 	glDrawBuffer(GL_COLOR_ATTACHMENT0);
 }
 
+// Attach every layer (cube face) - the geometry shader selects it with gl_Layer
+void Texture::BindForWritingLayered() const
+{
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, textureID, 0);
+	glDrawBuffer(GL_COLOR_ATTACHMENT0);
+}
+
 void Texture::SetParameters(GLenum mag_filter, GLenum min_filter, GLenum wrapping_mode)
 {
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag_filter);
@@ -162,13 +236,18 @@ void Texture::GetSize(unsigned int &width,unsigned int &height) const
 	height = this->height;
 }
 
-void Texture::Init2DTexture(unsigned int width, unsigned int height)
+// Returns false when there is no GL context to upload to
+bool Texture::Init2DTexture(unsigned int width, unsigned int height)
 {
 	this->width = width;
 	this->height = height;
 
+	if (Engine::IsHeadless())
+		return false;
+
 	glDeleteTextures(1, &textureID);
 	glGenTextures(1, &textureID);
 	glBindTexture(GL_TEXTURE_2D, textureID);
 	SetParameters(GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE);
+	return true;
 }
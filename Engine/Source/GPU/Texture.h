@@ -12,6 +12,7 @@ class DLLExport Texture
 
 		void Bind(GLenum TextureUnit) const;
 		void BindForWriting(GLenum textureTarget) const;
+		void BindForWritingLayered() const;
 
 		void Create2DTexture(const unsigned char* img, int width, int height, int chn);
 		void Create2DTexture(const unsigned short* img, int width, int height, int chn);
@@ -19,18 +20,28 @@ class DLLExport Texture
 		void Create2DTextureFloat(const float* data, int width, int height, int chn, int precision = 16);
 		void CreateFrameBufferTexture(int width, int height, int target_id);
 		void CreateDepthBufferTexture(int width, int height);
+		void CreateCubeDepthTexture(int width, int height);
 
 		void GetSize(unsigned int &width,unsigned int &height) const;
 		bool Load2D(const char* file_name, GLenum wrapping_mode = GL_REPEAT);
+
+		// Load2D in two steps - Decode reads the image on any thread, Upload creates
+		// the texture on the main thread and frees the pixels
+		bool Decode(const char* file_name);
+		bool Upload(GLenum wrapping_mode = GL_REPEAT);
 		GLuint GetTextureID();
 
 	private:
-		void Init2DTexture(unsigned int width, unsigned int height);
+		bool Init2DTexture(unsigned int width, unsigned int height);
 		void SetParameters(GLenum mag_filter, GLenum min_filter, GLenum wrapping_mode);
 	private:
 		unsigned int width;
 		unsigned int height;
 		GLuint textureID;
+
+		// Decoded image waiting for Upload
+		unsigned char *pixels;
+		int channels;
 };
 
 enum MIN_FILTER {
@@ -6,13 +6,17 @@
 #include <GPU/Shader.h>
 
 #include <Manager/AudioManager.h>
+#include <Manager/ConfigFile.h>
 #include <Manager/DebugInfo.h>
 #include <Manager/EventSystem.h>
 #include <Manager/Manager.h>
+#include <Manager/Profiler.h>
 #include <Manager/RenderingSystem.h>
 #include <Manager/SceneManager.h>
 #include <Manager/ShaderManager.h>
 
+#include <Rendering/FrustumCuller.h>
+
 #include <UI/MenuSystem.h>
 
 DebugInput::DebugInput()
@@ -37,6 +41,14 @@ void DebugInput::OnKeyPress(int key, int mods) {
 			case GLFW_KEY_V:
 				Manager::Debug->debugView = !Manager::Debug->debugView;
 				return;
+
+			case GLFW_KEY_T:
+				Manager::GetProfiler()->StartCapture(Manager::Config->traceFrames, Manager::Config->traceFile.c_str());
+				return;
+
+			case GLFW_KEY_B:
+				FrustumCuller::Benchmark(100000);
+				return;
 		}
 
 		{
@@ -65,6 +77,11 @@ void DebugInput::OnKeyPress(int key, int mods) {
 		return;
 	}
 
+	case GLFW_KEY_F2: {
+		Manager::Debug->profilerView = !Manager::Debug->profilerView;
+		return;
+	}
+
 	case GLFW_KEY_F3: {
 		Manager::RenderSys->Toggle(RenderState::WIREFRAME);
 		return;
@@ -79,6 +96,11 @@ void DebugInput::OnKeyPress(int key, int mods) {
 		Manager::Shader->Reload();
 		return;
 	}
+
+	case GLFW_KEY_F6: {
+		Manager::Scene->ReloadScene();
+		return;
+	}
 	}
 }
 
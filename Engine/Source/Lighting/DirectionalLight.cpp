@@ -4,6 +4,7 @@
 #include <Core/Camera/Camera.h>
 #include <Core/GameObject.h>
 #include <Component/AABB.h>
+#include <Component/ComponentStore.h>
 #include <Component/Renderer.h>
 #include <Component/Transform.h>
 
@@ -13,6 +14,9 @@
 #include <Manager/Manager.h>
 #include <Manager/SceneManager.h>
 #include <Manager/ShaderManager.h>
+#include <Rendering/RenderPacket.h>
+
+#include <Utils/3D.h>
 
 using namespace std;
 
@@ -46,7 +50,37 @@ void DirectionalLight::Update() {
 	Camera::Update();
 };
 
-void DirectionalLight::CastShadows(const Camera *camera) {
+/*
+ *	Assign the visible shadow casters to the cascades they can cast into
+ *	Each cascade volume is its light space ortho box without the near plane,
+ *	i.e. extruded toward the light, so casters between the light and the box are kept
+ */
+void DirectionalLight::CullCasters(RenderPacket &packet) {
+	casterCuller.Clear();
+	casterItems.clear();
+
+	unsigned int nrItems = (unsigned int)packet.items.size();
+	for (unsigned int i = 0; i < nrItems; i++) {
+		RenderItem &item = packet.items[i];
+		if (!(item.flags & RENDER_VISIBLE) || !(item.flags & RENDER_CAST_SHADOW) || !(item.flags & RENDER_BOUNDS))
+			continue;
+		casterCuller.Add((item.boundsMin + item.boundsMax) * 0.5f, (item.boundsMax - item.boundsMin) * 0.5f);
+		casterItems.push_back(i);
+	}
+
+	glm::vec4 planes[6];
+	unsigned int splits = (unsigned int)packet.cascadeViews.size();
+	for (unsigned int i = 0; i < splits; i++) {
+		Utils3D::ExtractFrustumPlanes(packet.cascadeProjections[i] * packet.cascadeViews[i], planes);
+		planes[4] = glm::vec4(0, 0, 0, 1);		// no near plane - always passes
+
+		casterCuller.Cull(planes, cascadeCasters);
+		for (auto index : cascadeCasters)
+			packet.items[casterItems[index]].cascadeMask |= 1 << i;
+	}
+}
+
+void DirectionalLight::CastShadows(const RenderPacket &packet) {
 	// Render pass
 	FBO->Bind(false);
 
@@ -83,19 +117,27 @@ void DirectionalLight::CastShadows(const Camera *camera) {
 	Shader *CSHM = Manager::Shader->GetShader("CSM");
 	CSHM->Use();
 
-	for (unsigned int i = 0; i < camera->splits; i++) {
+	unsigned int splits = (unsigned int)packet.cascadeViews.size();
+	for (unsigned int i = 0; i < splits; i++) {
 
 		glColorMask(i == 0, i == 1, i == 2, i == 3);
 		glClear(GL_DEPTH_BUFFER_BIT);
 
 		glUniform1i(CSHM->CSM_cascadeID, i);
-		glUniformMatrix4fv(CSHM->loc_view_matrix, 1, false, glm::value_ptr(lightViews[i]));
-		glUniformMatrix4fv(CSHM->loc_projection_matrix, 1, false, glm::value_ptr(lightProjections[i]));
-
-		for (auto *obj : Manager::Scene->frustumObjects) {
-			if (obj->renderer->CastShadow())
-				obj->Render(CSHM);
+		RenderView cascade;
+		cascade.View = packet.cascadeViews[i];
+		cascade.Projection = packet.cascadeProjections[i];
+		cascade.BindFrameData();
+
+		// Casters of a mesh are drawn instanced
+		casterQueue.Clear();
+		unsigned int nrItems = (unsigned int)packet.items.size();
+		for (unsigned int k = 0; k < nrItems; k++) {
+			if (packet.items[k].cascadeMask & (1 << i))
+				casterQueue.Add(RENDER_PASS_SHADOW, CSHM, packet, k, 0);
 		}
+		casterQueue.Sort();
+		casterQueue.Submit(packet);
 	}
 
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
@@ -109,11 +151,12 @@ void DirectionalLight::RenderDebug(const Shader *shader) const {
 	Light::RenderDebug(shader);
 }
 
-void DirectionalLight::BindForUse(const Shader *shader, Camera *camera) const
+void DirectionalLight::BindForUse(const Shader *shader, const RenderPacket &packet) const
 {
-	glUniform1fv(shader->CSM_SplitDistance, camera->splits, &camera->splitDistances[1]);
-	glUniformMatrix4fv(shader->CSM_LightView, camera->splits, false, glm::value_ptr(lightViews[0]));
-	glUniformMatrix4fv(shader->CSM_LightProjection, camera->splits, false, glm::value_ptr(lightProjections[0]));
+	GLsizei splits = (GLsizei)packet.cascadeViews.size();
+	glUniform1fv(shader->CSM_SplitDistance, splits, &packet.splitDistances[1]);
+	glUniformMatrix4fv(shader->CSM_LightView, splits, false, glm::value_ptr(packet.cascadeViews[0]));
+	glUniformMatrix4fv(shader->CSM_LightProjection, splits, false, glm::value_ptr(packet.cascadeProjections[0]));
 
 	glm::ivec2 rez = FBO->GetResolution();
 	glUniform2f(shader->loc_shadow_texel_size, 1.0f / rez.x, 1.0f / rez.y);
@@ -2,8 +2,11 @@
 
 #include <Lighting/Light.h>
 #include <Core/Camera/Camera.h>
+#include <Rendering/FrustumCuller.h>
+#include <Rendering/RenderQueue.h>
 
 class FrameBuffer;
+class RenderPacket;
 
 class DLLExport DirectionalLight : public Light, public Camera
 {
@@ -13,14 +16,21 @@ class DLLExport DirectionalLight : public Light, public Camera
 
 		void Init();
 		void Update();
-		void CastShadows(const Camera *camera);
+		void CullCasters(RenderPacket &packet);
+		void CastShadows(const RenderPacket &packet);
 		void RenderDebug(const Shader *shader) const;
-		void BindForUse(const Shader *shader, Camera *camera) const;
+		void BindForUse(const Shader *shader, const RenderPacket &packet) const;
 
 	public:
 		FrameBuffer *FBO;
 		float distanceTo;
 		vector<glm::mat4> lightProjections;
 		vector<glm::mat4> lightViews;
+
+	private:
+		FrustumCuller casterCuller;
+		vector<unsigned int> casterItems;
+		vector<unsigned int> cascadeCasters;
+		RenderQueue casterQueue;
 };
 
@@ -5,17 +5,20 @@
 
 #include <Core/Camera/Camera.h>
 #include <Core/GameObject.h>
+#include <Component/Mesh.h>
 #include <Component/Transform.h>
-#include <Component/Renderer.h>
 
 #include <GPU/Shader.h>
 #include <GPU/Texture.h>
 #include <GPU/FrameBuffer.h>
 
 #include <Manager/Manager.h>
-#include <Manager/SceneManager.h>
 #include <Manager/ShaderManager.h>
 
+#include <Rendering/RenderPacket.h>
+
+#include <Utils/3D.h>
+
 struct CameraDirection
 {
 	GLenum cubeMapFace;
@@ -23,14 +26,15 @@ struct CameraDirection
 	glm::vec3 up;
 };
 
+// Up vectors follow the cube map lookup convention, so the faces are sampled upright
 CameraDirection cameraDirections[6] =
 {
-	{ GL_TEXTURE_CUBE_MAP_POSITIVE_X, glm::vec3( 1.0f,  0.0f,  0.0f), glm::vec3(0.0f, 1.0f,  0.0f) },
-	{ GL_TEXTURE_CUBE_MAP_NEGATIVE_X, glm::vec3(-1.0f,  0.0f,  0.0f), glm::vec3(0.0f, 1.0f,  0.0f) },
-	{ GL_TEXTURE_CUBE_MAP_POSITIVE_Y, glm::vec3( 0.0f,  1.0f,  0.0f), glm::vec3(0.0f, 0.0f,  1.0f) },
-	{ GL_TEXTURE_CUBE_MAP_NEGATIVE_Y, glm::vec3( 0.0f, -1.0f,  0.0f), glm::vec3(0.0f, 0.0f, -1.0f) },
-	{ GL_TEXTURE_CUBE_MAP_POSITIVE_Z, glm::vec3( 0.0f,  0.0f,  1.0f), glm::vec3(0.0f, 1.0f,  0.0f) },
-	{ GL_TEXTURE_CUBE_MAP_NEGATIVE_Z, glm::vec3( 0.0f,  0.0f, -1.0f), glm::vec3(0.0f, 1.0f,  0.0f) }
+	{ GL_TEXTURE_CUBE_MAP_POSITIVE_X, glm::vec3( 1.0f,  0.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f) },
+	{ GL_TEXTURE_CUBE_MAP_NEGATIVE_X, glm::vec3(-1.0f,  0.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f) },
+	{ GL_TEXTURE_CUBE_MAP_POSITIVE_Y, glm::vec3( 0.0f,  1.0f,  0.0f), glm::vec3(0.0f,  0.0f,  1.0f) },
+	{ GL_TEXTURE_CUBE_MAP_NEGATIVE_Y, glm::vec3( 0.0f, -1.0f,  0.0f), glm::vec3(0.0f,  0.0f, -1.0f) },
+	{ GL_TEXTURE_CUBE_MAP_POSITIVE_Z, glm::vec3( 0.0f,  0.0f,  1.0f), glm::vec3(0.0f, -1.0f,  0.0f) },
+	{ GL_TEXTURE_CUBE_MAP_NEGATIVE_Z, glm::vec3( 0.0f,  0.0f, -1.0f), glm::vec3(0.0f, -1.0f,  0.0f) }
 };
 
 
@@ -38,44 +42,115 @@ PointLight::PointLight()
 	: GameObject("point-light")
 {
 	effectRadius = 10;
+	camera = nullptr;
+	cubeTexture = nullptr;
+	cubeDepth = nullptr;
+	FBO = nullptr;
+	layeredCaster = false;
 }
 
 PointLight::PointLight(const GameObject &obj)
 	: GameObject(obj)
 {
 	effectRadius = 10;
+	camera = nullptr;
+	cubeTexture = nullptr;
+	cubeDepth = nullptr;
+	FBO = nullptr;
+	layeredCaster = false;
 }
 
-void PointLight::RenderDeferred(Shader *shader) {
-	glUniform1f(shader->loc_light_radius, effectRadius / 2);
-	glm::BindUniform3f(shader->loc_light_color, diffuseColor);
-	glm::BindUniform3f(shader->loc_light_pos, transform->position);
+// Light volume is drawn from the packet data - the light itself may be simulated or deleted meanwhile
+void PointLight::RenderDeferred(Shader *shader, const RenderLight &data) {
+	glUniform1f(shader->loc_light_radius, data.radius / 2);
+	glm::BindUniform3f(shader->loc_light_color, data.color);
+	glm::BindUniform3f(shader->loc_light_pos, data.position);
 
-	glm::vec3 scale = transform->scale;
-	light->transform->SetScale(glm::vec3(effectRadius));
-	light->Render(shader);
-	light->transform->SetScale(scale);
+	glm::mat4 model = glm::scale(glm::translate(glm::mat4(1), data.position), glm::vec3(data.radius));
+	glUniformMatrix4fv(shader->loc_model_matrix, 1, GL_FALSE, glm::value_ptr(model));
+	data.volume->Render(shader);
 }
 
-void PointLight::CastShadows() {
-	
-	// Render pass
-	FBO->Bind();
-
-	Shader *CSHM = Manager::Shader->GetShader("VSM");
-	CSHM->Use();
+/*
+ *	Casters are culled to the light range first - an object farther than the
+ *	range can't be between the light and a lit point - then to each face frustum
+ *	The far plane is the light range, the shadow is not applied beyond it
+ */
+void PointLight::CastShadows(const RenderPacket &packet, const RenderLight &light) {
+	casterPosition = light.position;
+	if (camera->zFar != light.radius)
+		camera->SetPerspective(90, 1, 0.1f, light.radius);
+
+	const unsigned int CASTER = RENDER_CAST_SHADOW | RENDER_BOUNDS;
+	float range2 = light.radius * light.radius;
+
+	casters.clear();
+	casterCuller.Clear();
+	unsigned int nrItems = (unsigned int)packet.items.size();
+	for (unsigned int k = 0; k < nrItems; k++) {
+		const RenderItem &item = packet.items[k];
+		if ((item.flags & CASTER) != CASTER)
+			continue;
+
+		glm::vec3 closest = glm::clamp(casterPosition, item.boundsMin, item.boundsMax) - casterPosition;
+		if (glm::dot(closest, closest) > range2)
+			continue;
+
+		casterCuller.Add((item.boundsMin + item.boundsMax) * 0.5f, (item.boundsMax - item.boundsMin) * 0.5f);
+		casters.push_back(k);
+	}
 
+	glm::mat4 faceViews[6];
+	glm::vec4 planes[6];
+	faceMasks.assign(casters.size(), 0);
 	for (unsigned int i = 0; i < 6; i++) {
-		cubeTexture->BindForWriting(cameraDirections[i].cubeMapFace);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		// Views are built here - the camera transform lives in the store, which the simulation sweeps
+		faceViews[i] = glm::lookAt(casterPosition, casterPosition + cameraDirections[i].target, cameraDirections[i].up);
 
-		camera->Set(transform->position, cameraDirections[i].target, cameraDirections[i].up);
-		camera->BindViewMatrix(CSHM->loc_view_matrix);
-		camera->BindProjectionMatrix(CSHM->loc_projection_matrix);
+		Utils3D::ExtractFrustumPlanes(camera->Projection * faceViews[i], planes);
+		casterCuller.Cull(planes, faceCasters);
+		for (auto index : faceCasters)
+			faceMasks[index] |= 1 << i;
+	}
 
-		for (auto *obj : Manager::Scene->activeObjects) {
-			if (obj->renderer->CastShadow())
-				obj->Render(CSHM);
+	// Render pass - cleared to the far depth, texels without casters are lit
+	FBO->Bind();
+	glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+
+	if (layeredCaster) {
+		Shader *VSMCube = Manager::Shader->GetShader("VSMCube");
+		VSMCube->Use();
+
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		glUniformMatrix4fv(VSMCube->loc_cube_views, 6, GL_FALSE, glm::value_ptr(faceViews[0]));
+		camera->BindProjectionMatrix(VSMCube->loc_projection_matrix);
+
+		unsigned int nrCasters = (unsigned int)casters.size();
+		for (unsigned int k = 0; k < nrCasters; k++) {
+			if (!faceMasks[k])
+				continue;
+			glUniform1i(VSMCube->loc_face_mask, faceMasks[k]);
+			packet.RenderShadow(packet.items[casters[k]], VSMCube);
+		}
+	}
+	else {
+		Shader *CSHM = Manager::Shader->GetShader("VSM");
+		CSHM->Use();
+
+		RenderView face;
+		face.Set(camera);
+		face.position = casterPosition;
+		for (unsigned int i = 0; i < 6; i++) {
+			cubeTexture->BindForWriting(cameraDirections[i].cubeMapFace);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			face.View = faceViews[i];
+			face.BindFrameData();
+
+			unsigned int nrCasters = (unsigned int)casters.size();
+			for (unsigned int k = 0; k < nrCasters; k++) {
+				if (faceMasks[k] & (1 << i))
+					packet.RenderShadow(packet.items[casters[k]], CSHM);
+			}
 		}
 	}
 
@@ -84,14 +159,24 @@ void PointLight::CastShadows() {
 	FrameBuffer::Unbind();
 }
 
-void PointLight::InitCaster()
+void PointLight::InitCaster(bool layered)
 {
+	layeredCaster = layered;
 	FBO = new FrameBuffer();
 	FBO->Generate(1024, 1024, 0);
 	cubeTexture = new Texture();
 	cubeTexture->CreateCubeTexture(NULL, 1024, 1024, 4);
 	camera = new Camera();
 	camera->SetPerspective(90, 1, 0.1f, 50);
+
+	// every attachment of a layered framebuffer must be layered
+	if (layered) {
+		cubeDepth = new Texture();
+		FBO->Bind(false);
+		cubeDepth->CreateCubeDepthTexture(1024, 1024);
+		cubeTexture->BindForWritingLayered();
+		FrameBuffer::Unbind();
+	}
 }
 
 void PointLight::BindForUse(const Shader *shader) const
@@ -99,7 +184,7 @@ void PointLight::BindForUse(const Shader *shader) const
 	camera->BindViewMatrix(shader->loc_view_matrix);
 	camera->BindProjectionMatrix(shader->loc_projection_matrix);
 	camera->BindProjectionDistances(shader);
-	glm::BindUniform3f(shader->loc_light_pos, transform->position);
+	glm::BindUniform3f(shader->loc_light_pos, casterPosition);
 	BindTexture(GL_TEXTURE2);
 
 	glm::ivec2 rez = FBO->GetResolution();
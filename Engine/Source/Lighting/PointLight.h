@@ -2,10 +2,14 @@
 #include <Lighting/Light.h>
 #include <include/gl.h>
 
+#include <Rendering/FrustumCuller.h>
+
 class Camera;
 class Texture;
 class FrameBuffer;
+class RenderPacket;
 class Shader;
+struct RenderLight;
 
 class DLLExport PointLight : public Light
 {
@@ -13,9 +17,13 @@ class DLLExport PointLight : public Light
 		PointLight();
 		PointLight(const GameObject &obj);
 
-		void InitCaster();
-		void CastShadows();
-		void RenderDeferred(Shader *shader);
+		// A layered caster renders the six faces in one geometry shader pass
+		void InitCaster(bool layered = false);
+
+		// Render the cube shadow map of a packet light - casters are the packet items,
+		// so a caster can serve any light and never reads the scene
+		void CastShadows(const RenderPacket &packet, const RenderLight &light);
+		static void RenderDeferred(Shader *shader, const RenderLight &data);
 		void BindForUse(const Shader *shader) const;
 		void BindTexture(GLenum textureUnit) const;
 		void SetArea(float radius);
@@ -26,6 +34,15 @@ class DLLExport PointLight : public Light
 	private:
 		Camera *camera;
 		Texture *cubeTexture;
+		Texture *cubeDepth;
 		FrameBuffer *FBO;
+		bool layeredCaster;
+		glm::vec3 casterPosition;
+
+		// packet items in range and the faces each one is visible in
+		FrustumCuller casterCuller;
+		vector<unsigned int> casters;
+		vector<unsigned int> faceMasks;
+		vector<unsigned int> faceCasters;
 };
 
@@ -13,6 +13,7 @@
 #include <Manager/Manager.h>
 #include <Manager/SceneManager.h>
 #include <Manager/ShaderManager.h>
+#include <Rendering/RenderPacket.h>
 
 using namespace std;
 
@@ -57,7 +58,7 @@ void SpotLight::Update() {
 	}
 };
 
-void SpotLight::CastShadows() {
+void SpotLight::CastShadows(const RenderPacket &packet, const RenderView &view) {
 	// Render pass
 	FBO->Bind(false);
 
@@ -67,13 +68,11 @@ void SpotLight::CastShadows() {
 
 	Shader *CSHM = Manager::Shader->GetShader("VSM");
 	CSHM->Use();
+	view.BindFrameData();
 
-	BindViewMatrix(CSHM->loc_view_matrix);
-	BindProjectionMatrix(CSHM->loc_projection_matrix);
-
-	for (auto *obj : Manager::Scene->activeObjects) {
-		if (obj->renderer->CastShadow())
-			obj->Render(CSHM);
+	for (auto &item : packet.items) {
+		if (item.flags & RENDER_CAST_SHADOW)
+			packet.RenderShadow(item, CSHM);
 	}
 
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
@@ -85,11 +84,11 @@ void SpotLight::RenderDebug(const Shader *shader) const {
 	Camera::RenderDebug(shader);
 }
 
-void SpotLight::BindForUse(const Shader *shader) const
+void SpotLight::BindForUse(const Shader *shader, const RenderView &view) const
 {
-	BindViewMatrix(shader->loc_view_matrix);
-	BindProjectionMatrix(shader->loc_projection_matrix);
-	BindProjectionDistances(shader);
+	view.BindViewMatrix(shader->loc_view_matrix);
+	view.BindProjectionMatrix(shader->loc_projection_matrix);
+	view.BindProjectionDistances(shader);
 
 	FBO->BindTexture(0, GL_TEXTURE1);
 	glm::ivec2 rez = FBO->GetResolution();
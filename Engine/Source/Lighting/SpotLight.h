@@ -4,6 +4,8 @@
 #include <Core/Camera/Camera.h>
 
 class FrameBuffer;
+class RenderPacket;
+struct RenderView;
 
 class DLLExport SpotLight : public Light, public Camera
 {
@@ -13,9 +15,9 @@ class DLLExport SpotLight : public Light, public Camera
 
 		void Init();
 		void Update();
-		void CastShadows();
+		void CastShadows(const RenderPacket &packet, const RenderView &view);
 		void RenderDebug(const Shader *shader) const;
-		void BindForUse(const Shader *shader) const;
+		void BindForUse(const Shader *shader, const RenderView &view) const;
 		void SplitFrustum(unsigned int splits);
 
 	public:
@@ -11,6 +11,7 @@
 
 #include <Manager/DebugInfo.h>
 #include <Manager/Manager.h>
+#include <Manager/Profiler.h>
 #include <Component/Transform.h>
 
 
@@ -27,6 +28,8 @@ void AudioManager::Init() {
 
 void AudioManager::LoadAudio(const string &fileLocation, const string &UID, AUDIO_TYPE TYPE)
 {
+	PROFILE_SCOPE("Load Audio");
+
 	switch (TYPE) {
 
 		case AUDIO_TYPE::MUSIC: {
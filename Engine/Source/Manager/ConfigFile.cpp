@@ -10,6 +10,15 @@ pugi::xml_node *config;
 pugi::xml_document *doc;
 
 ConfigFile::ConfigFile() {
+	tickRate = 60;
+	pipeline = false;
+	headless = false;
+	headlessFrames = 0;
+	pointShadows = 0;
+	pointShadowsLayered = false;
+	traceStartup = false;
+	traceFrames = 120;
+	traceFile = "trace.json";
 }
 
 ConfigFile::~ConfigFile() {
@@ -24,6 +33,35 @@ void ConfigFile::Load(const char *fileName) {
 	resolution = glm::ExtractVector<glm::ivec2>(config->child_value("resolution"));
 	position = glm::ExtractVector<glm::ivec2>(config->child_value("position"));
 
+	// Simulation ticks per second
+	int rate = atoi(config->child_value("tickrate"));
+	if (rate > 0)
+		tickRate = rate;
+
+	// Overlap simulation of the next frame with rendering of the current one
+	pipeline = strcmp(config->child_value("pipeline"), "true") == 0;
+
+	// Run without window or GL context (0 frames = until exit)
+	headless = strcmp(config->child_value("headless"), "true") == 0;
+	headlessFrames = atoi(config->child_value("headless-frames"));
+
+	// Cube shadow maps for the closest point lights - layered renders the faces in one pass
+	pugi::xml_node shadows = config->child("point-shadows");
+	if (shadows) {
+		pointShadows = shadows.attribute("lights").as_uint();
+		pointShadowsLayered = shadows.attribute("layered").as_bool();
+	}
+
+	// Chrome trace capture - started with the debug key or right from startup
+	pugi::xml_node trace = config->child("trace");
+	if (trace) {
+		traceStartup = trace.attribute("startup").as_bool();
+		if (trace.attribute("frames").as_uint())
+			traceFrames = trace.attribute("frames").as_uint();
+		if (*trace.attribute("file").value())
+			traceFile = trace.attribute("file").value();
+	}
+
 }
 
 const char* ConfigFile::GetResourceFileLoc(const char *resourceID) {
@@ -1,4 +1,6 @@
 #pragma once
+#include <string>
+
 #include <include/dll_export.h>
 #include <include/glm.h>
 
@@ -15,5 +17,18 @@ class DLLExport ConfigFile
 	public:
 		glm::ivec2 resolution;
 		glm::ivec2 position;
+		unsigned int tickRate;
+		bool pipeline;
+		bool headless;
+		unsigned int headlessFrames;
+
+		// Point lights with cube shadow maps (the closest ones to the camera)
+		unsigned int pointShadows;
+		bool pointShadowsLayered;
+
+		// Profiler trace capture
+		bool traceStartup;
+		unsigned int traceFrames;
+		std::string traceFile;
 };
 
@@ -8,6 +8,8 @@
 #include <include/utils.h>
 
 #include <Component/AABB.h>
+#include <Component/Text.h>
+#include <Component/Transform.h>
 #include <Core/Engine.h>
 #include <Core/Camera/Camera.h>
 #include <Core/GameObject.h>
@@ -18,16 +20,22 @@
 #include <Manager/ShaderManager.h>
 #include <Manager/Manager.h>
 #include <Manager/RenderingSystem.h>
+#include <Manager/Profiler.h>
 
 #include <Utils/GPU.h>
 
 DebugInfo::DebugInfo() {
 	debugMessages = false;
 	debugView = false;
+	profilerView = false;
+	profilerRefreshTime = 0;
+	nrProfilerLines = 0;
 }
 
 DebugInfo::~DebugInfo() {
 	SAFE_FREE(FBO);
+	for (auto line : profilerLines)
+		SAFE_FREE(line);
 }
 
 void DebugInfo::Init() {
@@ -96,4 +104,74 @@ void DebugInfo::Render(const Camera *camera) const {
 		glLineWidth(1);
 	}
 	FrameBuffer::Unbind();
-}
\ No newline at end of file
+}
+
+// Timings are averaged over the profiler history and the text is only rebuilt
+// a few times per second so the values stay readable
+void DebugInfo::RenderProfiler() {
+	if (!profilerView) return;
+
+	double time = Engine::GetElapsedTime();
+	if (time - profilerRefreshTime > 0.25 || time < profilerRefreshTime) {
+		profilerRefreshTime = time;
+		UpdateProfilerText();
+	}
+
+	// Pixel space projection - origin in the bottom left corner
+	glm::ivec2 resolution = Engine::Window->resolution;
+	glm::mat4 projection = glm::ortho(0.0f, (float)resolution.x, 0.0f, (float)resolution.y);
+
+	Shader *shader = Manager::Shader->GetShader("font");
+	shader->Use();
+	glUniformMatrix4fv(shader->loc_projection_matrix, 1, false, glm::value_ptr(projection));
+	glUniformMatrix4fv(shader->loc_view_matrix, 1, false, glm::value_ptr(glm::mat4(1.0f)));
+	glUniform3f(shader->text_color, 0.967f, 0.873f, 0.486f);
+	glDisable(GL_DEPTH_TEST);
+
+	for (unsigned int i = 0; i < nrProfilerLines; i++) {
+		profilerLines[i]->Render(shader);
+	}
+
+	glEnable(GL_DEPTH_TEST);
+}
+
+void DebugInfo::UpdateProfilerText() {
+	const float lineHeight = 16;
+	const float textScale = 0.3f;
+
+	Profiler *profiler = Manager::GetProfiler();
+	profiler->GetStats(profilerStats);
+
+	vector<string> lines;
+	char buffer[256];
+
+	double frameTime = profiler->GetAverageFrameTime();
+	sprintf(buffer, "Frame %.2lf ms (%.0lf FPS)    last / avg / max", frameTime, frameTime > 0 ? 1000 / frameTime : 0);
+	lines.push_back(buffer);
+
+	for (auto &stat : profilerStats) {
+		sprintf(buffer, "%s %*s%s  %.2lf / %.2lf / %.2lf", stat.gpu ? "GPU" : "CPU", stat.depth * 2, "", stat.name, stat.last, stat.average, stat.max);
+		lines.push_back(buffer);
+	}
+
+	profiler->GetCounters(profilerCounters);
+	for (auto &counter : profilerCounters) {
+		sprintf(buffer, "    %s  %u", counter.name, counter.value);
+		lines.push_back(buffer);
+	}
+
+	glm::ivec2 resolution = Engine::Window->resolution;
+	while (profilerLines.size() < lines.size()) {
+		Text *line = new Text();
+		line->transform->position = glm::vec3(10, resolution.y - lineHeight * (profilerLines.size() + 1), 0);
+		line->transform->scale = glm::vec3(textScale);
+		line->transform->Update();
+		profilerLines.push_back(line);
+	}
+
+	nrProfilerLines = (unsigned int)lines.size();
+	for (unsigned int i = 0; i < nrProfilerLines; i++) {
+		if (profilerLines[i]->content != lines[i])
+			profilerLines[i]->SetText(lines[i].c_str());
+	}
+}
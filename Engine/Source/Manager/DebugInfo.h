@@ -1,11 +1,14 @@
 #pragma once
 #include <list>
+#include <vector>
 
 #include <include/dll_export.h>
+#include <Manager/Profiler.h>
 
 class GameObject;
 class FrameBuffer;
 class Camera;
+class Text;
 
 class DLLExport DebugInfo
 {
@@ -21,9 +24,23 @@ class DLLExport DebugInfo
 		void Render(const Camera *camera) const;
 		void BindForRendering(const Camera *camera) const;
 
+		// Per scope CPU/GPU timings collected by the Profiler
+		void RenderProfiler();
+
+	private:
+		void UpdateProfilerText();
+
 	public:
 		bool debugView;
 		bool debugMessages;
+		bool profilerView;
 		FrameBuffer *FBO;
 		std::list<GameObject*> objects;
+
+	private:
+		double profilerRefreshTime;
+		unsigned int nrProfilerLines;
+		std::vector<Text*> profilerLines;
+		std::vector<ProfileStat> profilerStats;
+		std::vector<ProfileCounter> profilerCounters;
 };
\ No newline at end of file
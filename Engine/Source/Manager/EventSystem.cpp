@@ -3,6 +3,8 @@
 
 #include <include/gl.h>
 
+#include <Core/Engine.h>
+
 #include <Manager/DebugInfo.h>
 #include <Event/EventListener.h>
 #include <Manager/Manager.h>
@@ -65,13 +67,12 @@ TimedEvent::TimedEvent(EventListener *E, EventType Event, Object *data, float de
 	event = E;
 	type = Event;
 	this->data = data;
-	triggerTime = float(glfwGetTime()) + delaySeconds;
+	triggerTime = float(Engine::GetElapsedTime()) + delaySeconds;
 }
 
 bool TimedEvent::Update()
 {
-	float deltaTime = float(glfwGetTime());
-	if (float(glfwGetTime()) > triggerTime) {
+	if (float(Engine::GetElapsedTime()) > triggerTime) {
 		event->OnEvent(type, NULL);
 		return true;
 	}
@@ -4,6 +4,7 @@
 #include <string>
 
 #include "Manager.h"
+#include <Core/Engine.h>
 #include <Manager/DebugInfo.h>
 #include <Core/GameObject.h>
 
@@ -51,7 +52,8 @@ void FontManager::Init() {
     map = MakeDistanceMap(atlas->data, atlas->width, atlas->height);
     memcpy( atlas->data, map, atlas->width*atlas->height*sizeof(unsigned char) );
     free(map);
-    texture_atlas_upload( atlas );
+	if (!Engine::IsHeadless())
+		texture_atlas_upload( atlas );
 }
 
 unsigned char * FontManager::MakeDistanceMap( unsigned char *img, unsigned int width, unsigned int height )
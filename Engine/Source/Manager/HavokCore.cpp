@@ -2,10 +2,12 @@
 #include "HavokCore.h"
 
 #include <cstdio>
+#include <malloc.h>
 
 #include <include/havok.h>
 
 #include <Manager/DebugInfo.h>
+#include <Manager/JobSystem.h>
 #include <Manager/Manager.h>
 
 // Math and base includes
@@ -94,6 +96,7 @@ void HavokCore::Init()
 	Manager::Debug->InitManager("Havok");
 
 	InitMemory();
+	InitJobThreads();
 	InitPhysicsWorld();
 
 	if (_vdbEnabled)
@@ -152,6 +155,32 @@ void HavokCore::InitMemory()
 	hkMonitorStream::getInstance().resize(200000);
 }
 
+// The pipelined simulation (see Engine::SetPipelined) steps the world and copies
+// physics objects from job threads - each one needs its own Havok memory router
+void HavokCore::InitJobThreads()
+{
+	_workerRouters.assign(Manager::GetJobs()->GetThreadCount(), nullptr);
+
+	Manager::GetJobs()->AddThreadHook(
+		[this](unsigned int index) {
+			// Placement only - the router cannot come from Havok memory before it exists
+			void *storage = _aligned_malloc(sizeof(hkMemoryRouter), 16);
+			hkMemoryRouter *router = new (storage) hkMemoryRouter();
+			hkMemorySystem::getInstance().threadInit(*router, "JobSystem");
+			hkBaseSystem::initThread(router);
+			hkMonitorStream::getInstance().resize(200000);
+			_workerRouters[index] = router;
+		},
+		[this](unsigned int index) {
+			hkMemoryRouter *router = _workerRouters[index];
+			hkBaseSystem::quitThread();
+			hkMemorySystem::getInstance().threadQuit(*router);
+			router->~hkMemoryRouter();
+			_aligned_free(router);
+			_workerRouters[index] = nullptr;
+		});
+}
+
 void HavokCore::InitPhysicsWorld()
 {
 	_pWorldInfo = new hkpWorldCinfo();
@@ -237,7 +266,7 @@ void HavokCore::StepPhysicsSimulation(float deltaTime)
 	// Step the physics world. This single call steps using this thread and all threads
 	// in the threadPool. For other products you add jobs, call process all jobs and wait for completion.
 	// See the multithreading chapter in the user guide for details.
-	_pWorld->stepMultithreaded( _jobQueue, _threadPool, 0.016f);
+	_pWorld->stepMultithreaded( _jobQueue, _threadPool, deltaTime);
 }
 
 void HavokCore::StepVDBSimulation()
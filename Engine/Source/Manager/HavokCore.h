@@ -1,5 +1,6 @@
 #pragma once
 #include <list>
+#include <vector>
 
 #include <include/dll_export.h>
 
@@ -10,6 +11,7 @@ class hkVisualDebugger;
 class hkJobQueue;
 class hkpWorldCinfo;
 class hkJobThreadPool;
+class hkMemoryRouter;
 
 class DLLExport HavokCore
 {
@@ -19,6 +21,7 @@ class DLLExport HavokCore
 
 	private:
 		void InitMemory();
+		void InitJobThreads();
 		void InitPhysicsWorld();
 		void InitVDB();
 
@@ -59,4 +62,7 @@ class DLLExport HavokCore
 
 		std::list<hkpEntity*> toAdd;
 		std::list<hkpEntity*> toRemove;
+
+		// Memory routers of the JobSystem workers - indexed by thread
+		std::vector<hkMemoryRouter*> _workerRouters;
 };
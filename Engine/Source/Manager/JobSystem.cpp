@@ -0,0 +1,298 @@
+//#include <pch.h>
+#include "JobSystem.h"
+
+#include <iostream>
+
+#include <Manager/Profiler.h>
+
+// Queue owned by the current thread
+static __declspec(thread) unsigned int threadIndex = 0;
+
+Job::Job(const char *name, function<void()> task)
+	: name(name), task(task)
+{
+	pendingDependencies = 1;
+	done = false;
+}
+
+bool Job::IsDone() const
+{
+	return done;
+}
+
+JobSystem::JobSystem()
+{
+	running = false;
+	queuedJobs = 0;
+	nrHooks = 0;
+}
+
+JobSystem::~JobSystem()
+{
+	Shutdown();
+}
+
+void JobSystem::Init(unsigned int workerCount)
+{
+	if (running) return;
+
+	if (workerCount == 0) {
+		unsigned int hwThreads = thread::hardware_concurrency();
+		workerCount = hwThreads > 1 ? hwThreads - 1 : 1;
+	}
+
+	running = true;
+	threadIndex = 0;
+
+	for (unsigned int i = 0; i <= workerCount; i++)
+		queues.push_back(new WorkQueue());
+	hooksDone.assign(workerCount + 1, 0);
+
+	for (unsigned int i = 1; i <= workerCount; i++)
+		workers.push_back(thread(&JobSystem::WorkerLoop, this, i));
+
+	cout << "JobSystem: " << workerCount << " worker threads" << endl;
+}
+
+void JobSystem::Shutdown()
+{
+	if (!running) return;
+
+	{
+		lock_guard<mutex> guard(sleepLock);
+		running = false;
+	}
+	wakeUp.notify_all();
+
+	for (auto &worker : workers)
+		worker.join();
+	workers.clear();
+
+	for (auto queue : queues)
+		delete queue;
+	queues.clear();
+}
+
+unsigned int JobSystem::GetWorkerCount() const
+{
+	return (unsigned int)workers.size();
+}
+
+unsigned int JobSystem::GetThreadCount() const
+{
+	return (unsigned int)workers.size() + 1;
+}
+
+unsigned int JobSystem::GetThreadIndex()
+{
+	return threadIndex;
+}
+
+JobHandle JobSystem::Schedule(function<void()> task)
+{
+	return Schedule("Job", task, vector<JobHandle>());
+}
+
+JobHandle JobSystem::Schedule(function<void()> task, const JobHandle &dependency)
+{
+	vector<JobHandle> dependencies;
+	if (dependency)
+		dependencies.push_back(dependency);
+	return Schedule("Job", task, dependencies);
+}
+
+JobHandle JobSystem::Schedule(function<void()> task, const vector<JobHandle> &dependencies)
+{
+	return Schedule("Job", task, dependencies);
+}
+
+JobHandle JobSystem::Schedule(const char *name, function<void()> task)
+{
+	return Schedule(name, task, vector<JobHandle>());
+}
+
+JobHandle JobSystem::Schedule(const char *name, function<void()> task, const vector<JobHandle> &dependencies)
+{
+	JobHandle job(new Job(name, task));
+
+	// Register as continuation of every unfinished dependency
+	// pendingDependencies starts at 1 so the job can't be released before all are registered
+	for (auto &dep : dependencies) {
+		if (!dep) continue;
+		lock_guard<mutex> guard(dep->lock);
+		if (!dep->done) {
+			job->pendingDependencies++;
+			dep->continuations.push_back(job);
+		}
+	}
+
+	if (--job->pendingDependencies == 0)
+		Enqueue(job);
+
+	return job;
+}
+
+JobHandle JobSystem::ScheduleParallelFor(unsigned int count, unsigned int batchSize, function<void(unsigned int, unsigned int)> task)
+{
+	if (batchSize == 0)
+		batchSize = 1;
+
+	vector<JobHandle> batches;
+	batches.reserve(count / batchSize + 1);
+	for (unsigned int start = 0; start < count; start += batchSize) {
+		unsigned int end = count - start > batchSize ? start + batchSize : count;
+		batches.push_back(Schedule("Parallel For", [task, start, end]() { task(start, end); }));
+	}
+
+	// Empty job used only to join all batches
+	return Schedule("Parallel For Join", []() {}, batches);
+}
+
+void JobSystem::ParallelFor(unsigned int count, unsigned int batchSize, function<void(unsigned int, unsigned int)> task)
+{
+	if (count == 0) return;
+
+	// Not worth the scheduling overhead
+	if (!running || count <= batchSize) {
+		task(0, count);
+		return;
+	}
+
+	Wait(ScheduleParallelFor(count, batchSize, task));
+}
+
+void JobSystem::Wait(const JobHandle &job)
+{
+	if (!job) return;
+	while (!job->done) {
+		if (!ExecuteNext(threadIndex))
+			this_thread::yield();
+	}
+}
+
+void JobSystem::Enqueue(const JobHandle &job)
+{
+	// Run inline when the scheduler is not started (or already shut down)
+	if (!running || queues.empty()) {
+		Execute(job);
+		return;
+	}
+
+	unsigned int index = threadIndex < queues.size() ? threadIndex : 0;
+	{
+		lock_guard<mutex> guard(queues[index]->lock);
+		queues[index]->jobs.push_back(job);
+	}
+	queuedJobs++;
+
+	{
+		lock_guard<mutex> guard(sleepLock);
+	}
+	wakeUp.notify_one();
+}
+
+bool JobSystem::Pop(unsigned int index, JobHandle &job)
+{
+	WorkQueue *queue = queues[index];
+	lock_guard<mutex> guard(queue->lock);
+	if (queue->jobs.empty())
+		return false;
+	job = queue->jobs.back();
+	queue->jobs.pop_back();
+	return true;
+}
+
+bool JobSystem::Steal(unsigned int index, JobHandle &job)
+{
+	unsigned int nrQueues = (unsigned int)queues.size();
+	for (unsigned int i = 1; i < nrQueues; i++) {
+		WorkQueue *queue = queues[(index + i) % nrQueues];
+		lock_guard<mutex> guard(queue->lock);
+		if (queue->jobs.empty())
+			continue;
+		job = queue->jobs.front();
+		queue->jobs.pop_front();
+		return true;
+	}
+	return false;
+}
+
+bool JobSystem::ExecuteNext(unsigned int index)
+{
+	if (queues.empty())
+		return false;
+
+	if (index)
+		RunThreadHooks(index);
+
+	JobHandle job;
+	if (!Pop(index, job) && !Steal(index, job))
+		return false;
+
+	queuedJobs--;
+	Execute(job);
+	return true;
+}
+
+void JobSystem::Execute(const JobHandle &job)
+{
+	{
+		PROFILE_SCOPE(job->name);
+		job->task();
+	}
+
+	vector<JobHandle> continuations;
+	{
+		lock_guard<mutex> guard(job->lock);
+		job->done = true;
+		continuations.swap(job->continuations);
+	}
+
+	for (auto &next : continuations) {
+		if (--next->pendingDependencies == 0)
+			Enqueue(next);
+	}
+}
+
+void JobSystem::AddThreadHook(function<void(unsigned int)> init, function<void(unsigned int)> exit)
+{
+	lock_guard<mutex> guard(hookLock);
+	ThreadHook hook;
+	hook.init = init;
+	hook.exit = exit;
+	hooks.push_back(hook);
+	nrHooks++;
+}
+
+void JobSystem::RunThreadHooks(unsigned int index)
+{
+	if (hooksDone[index] == nrHooks)
+		return;
+
+	lock_guard<mutex> guard(hookLock);
+	while (hooksDone[index] < hooks.size()) {
+		if (hooks[hooksDone[index]].init)
+			hooks[hooksDone[index]].init(index);
+		hooksDone[index]++;
+	}
+}
+
+void JobSystem::WorkerLoop(unsigned int index)
+{
+	threadIndex = index;
+
+	while (running) {
+		if (ExecuteNext(index))
+			continue;
+
+		unique_lock<mutex> guard(sleepLock);
+		wakeUp.wait(guard, [this]() { return queuedJobs > 0 || !running; });
+	}
+
+	// Reverse order - later hooks may depend on the earlier ones
+	lock_guard<mutex> guard(hookLock);
+	for (unsigned int i = hooksDone[index]; i-- > 0;) {
+		if (hooks[i].exit)
+			hooks[i].exit(index);
+	}
+}
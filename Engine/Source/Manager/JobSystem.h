@@ -0,0 +1,116 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <include/dll_export.h>
+
+using namespace std;
+
+class Job;
+typedef shared_ptr<Job> JobHandle;
+
+/*
+ *	Unit of work executed by the JobSystem
+ *	A job becomes runnable once all of its dependencies finished
+ */
+class DLLExport Job
+{
+	friend class JobSystem;
+
+	public:
+		Job(const char *name, function<void()> task);
+		bool IsDone() const;
+
+	private:
+		const char *name;
+		function<void()> task;
+		atomic<int> pendingDependencies;
+		atomic<bool> done;
+
+		mutex lock;
+		vector<JobHandle> continuations;
+};
+
+/*
+ *	Work-stealing scheduler
+ *	Each thread owns a deque - the owner pushes and pops at the back,
+ *	idle threads steal from the front of other queues
+ *	Queue 0 belongs to the main thread
+ */
+class DLLExport JobSystem
+{
+	protected:
+		JobSystem();
+		~JobSystem();
+
+	public:
+		// workerCount = 0 uses one worker per hardware thread except the main one
+		void Init(unsigned int workerCount = 0);
+		void Shutdown();
+
+		JobHandle Schedule(function<void()> task);
+		JobHandle Schedule(function<void()> task, const JobHandle &dependency);
+		JobHandle Schedule(function<void()> task, const vector<JobHandle> &dependencies);
+
+		// Named jobs show up under their name in profiler captures (string literal)
+		JobHandle Schedule(const char *name, function<void()> task);
+		JobHandle Schedule(const char *name, function<void()> task, const vector<JobHandle> &dependencies);
+
+		// Split [0, count) in batches of batchSize and run them on all threads
+		// The task receives the [start, end) range of the batch
+		JobHandle ScheduleParallelFor(unsigned int count, unsigned int batchSize, function<void(unsigned int, unsigned int)> task);
+		void ParallelFor(unsigned int count, unsigned int batchSize, function<void(unsigned int, unsigned int)> task);
+
+		// Block until the job finished - the calling thread executes other jobs meanwhile
+		void Wait(const JobHandle &job);
+
+		unsigned int GetWorkerCount() const;
+		unsigned int GetThreadCount() const;
+
+		// Per thread setup of a library (e.g. Havok memory) - init runs on every worker
+		// before the next job it executes, exit when the worker stops
+		// The hooks receive the thread index - the main thread is left to the caller
+		void AddThreadHook(function<void(unsigned int)> init, function<void(unsigned int)> exit);
+
+		// Index of the calling thread's queue (0 for the main thread and foreign threads)
+		static unsigned int GetThreadIndex();
+
+	private:
+		void WorkerLoop(unsigned int index);
+		bool ExecuteNext(unsigned int index);
+		void RunThreadHooks(unsigned int index);
+		void Execute(const JobHandle &job);
+		void Enqueue(const JobHandle &job);
+		bool Pop(unsigned int index, JobHandle &job);
+		bool Steal(unsigned int index, JobHandle &job);
+
+	private:
+		struct WorkQueue {
+			mutex lock;
+			deque<JobHandle> jobs;
+		};
+
+		struct ThreadHook {
+			function<void(unsigned int)> init;
+			function<void(unsigned int)> exit;
+		};
+
+		vector<WorkQueue*> queues;
+		vector<thread> workers;
+
+		mutex hookLock;
+		vector<ThreadHook> hooks;
+		atomic<unsigned int> nrHooks;
+		vector<unsigned int> hooksDone;		// per thread - only written by its owner
+
+		atomic<bool> running;
+		atomic<int> queuedJobs;
+		mutex sleepLock;
+		condition_variable wakeUp;
+};
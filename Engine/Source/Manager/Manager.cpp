@@ -7,6 +7,7 @@
 #include <templates/singleton.h>
 
 #include <Component/AABB.h>
+#include <Component/ComponentStore.h>
 
 #include <Core/Engine.h>
 #include <Core/InputSystem.h>
@@ -20,6 +21,8 @@
 #include <Manager/DebugInfo.h>
 #include <Manager/EventSystem.h>
 #include <Manager/FontManager.h>
+#include <Manager/JobSystem.h>
+#include <Manager/Profiler.h>
 #include <Manager/RenderingSystem.h>
 #include <Manager/ResourceManager.h>
 #include <Manager/SceneManager.h>
@@ -45,6 +48,9 @@ SceneManager*		Manager::Scene = nullptr;
 ShaderManager*		Manager::Shader = nullptr;
 TextureManager*		Manager::Texture = nullptr;
 RenderingSystem*	Manager::RenderSys = nullptr;
+JobSystem*			Manager::Jobs = nullptr;
+Profiler*			Manager::Profile = nullptr;
+ComponentStore*		Manager::Components = nullptr;
 #ifdef PHYSICS_ENGINE
 HavokCore*			Manager::Havok = nullptr;
 PhysicsManager*		Manager::Physics = nullptr;
@@ -52,8 +58,16 @@ PhysicsManager*		Manager::Physics = nullptr;
 
 void Manager::Init() {
 
+	// Every Transform allocates its data here
+	Components = Singleton<ComponentStore>::Instance();
+
 	InputSystem::Init();
 
+	Jobs = Singleton<JobSystem>::Instance();
+	Jobs->Init();
+
+	Profile = Singleton<Profiler>::Instance();
+
 	Debug = Singleton<DebugInfo>::Instance();
 	Debug->InitManager("Manager");
 
@@ -91,22 +105,33 @@ void Manager::Init() {
 void Manager::LoadConfig() {
 
 	Config->Load("config.xml");
+	Engine::SetFixedTimeStep(Config->tickRate);
+	Engine::SetPipelined(Config->pipeline);
+	Engine::SetHeadless(Config->headless, Config->headlessFrames);
 
-	Engine::Window = WindowManager::NewWindow("Engine", Config->resolution, Config->position, true);
+	if (Engine::IsHeadless())
+		Engine::Window = WindowManager::NewHeadlessWindow("Engine", Config->resolution);
+	else
+		Engine::Window = WindowManager::NewWindow("Engine", Config->resolution, Config->position, true);
 
 	RenderSys->Init();
 
 	////////////////////////////////////////
 	// TODO inspect if I can move these
 
-	glewExperimental = true;
-	glewInit();
+	if (!Engine::IsHeadless()) {
+		glewExperimental = true;
+		glewInit();
 
-	/* Force Vertical Sync */
-	wglSwapIntervalEXT(1);
+		/* Force Vertical Sync */
+		wglSwapIntervalEXT(1);
+	}
 
 	////////////////////////////////////////
 
+	Profile->Init();
+	if (Config->traceStartup)
+		Profile->StartCapture(Config->traceFrames, Config->traceFile.c_str());
 	Debug->Init();
 #ifdef PHYSICS_ENGINE
 	Havok->Init();
@@ -172,6 +197,21 @@ ConfigFile* Manager::GetConfig()
 	return Config;
 }
 
+JobSystem* Manager::GetJobs()
+{
+	return Jobs;
+}
+
+Profiler* Manager::GetProfiler()
+{
+	return Profile;
+}
+
+ComponentStore* Manager::GetComponents()
+{
+	return Components;
+}
+
 #ifdef PHYSICS_ENGINE
 HavokCore* Manager::GetHavok()
 {
@@ -5,10 +5,13 @@
 
 class AudioManager;
 class ColorManager;
+class ComponentStore;
 class DebugInfo;
 class EventSystem;
 class FontManager;
+class JobSystem;
 class MenuSystem;
+class Profiler;
 class ResourceManager;
 class TextureManager;
 class SceneManager;
@@ -42,6 +45,9 @@ class Manager
 		DLLExport static MenuSystem*		GetMenu();
 		DLLExport static TextureManager*	GetTexture();
 		DLLExport static ConfigFile*		GetConfig();
+		DLLExport static JobSystem*			GetJobs();
+		DLLExport static Profiler*			GetProfiler();
+		DLLExport static ComponentStore*	GetComponents();
 
 		#ifdef PHYSICS_ENGINE
 		DLLExport static HavokCore* GetHavok();
@@ -61,6 +67,9 @@ class Manager
 		static ShaderManager	*Shader;
 		static ConfigFile		*Config;
 		static RenderingSystem	*RenderSys;
+		static JobSystem		*Jobs;
+		static Profiler			*Profile;
+		static ComponentStore	*Components;
 
 		#ifdef PHYSICS_ENGINE
 		static HavokCore *Havok;
@@ -0,0 +1,490 @@
+//#include <pch.h>
+#include "Profiler.h"
+
+#include <Windows.h>
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+
+#include <Core/Engine.h>
+#include <Manager/JobSystem.h>
+#include <Manager/Manager.h>
+
+/*
+ *	Events recorded by one thread during the current frame
+ *	Only the owner thread pushes - the lock guards against EndFrame collecting
+ */
+struct ProfileThread
+{
+	mutex lock;
+	unsigned short threadID;
+	vector<ProfileEvent> events;
+	vector<unsigned int> stack;
+};
+
+static __declspec(thread) ProfileThread *profileThread = nullptr;
+
+// Thread ID used for GPU events
+static const unsigned short GPU_THREAD = 0xFFFF;
+
+static LARGE_INTEGER timerStart;
+static double timerPeriod = 0;
+
+Profiler::Profiler()
+{
+	frameID = 0;
+	frameStart = 0;
+	gpuTiming = false;
+	gpuClockOffset = 0;
+	historySize = 0;
+	capturing = false;
+	captureFirst = 0;
+	captureLast = 0;
+	history.resize(HISTORY_SIZE);
+
+	for (unsigned int i = 0; i < GPU_LATENCY; i++)
+		gpuFrames[i].frameID = 0;
+
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&timerStart);
+	timerPeriod = 1000.0 / frequency.QuadPart;
+}
+
+Profiler::~Profiler()
+{
+	for (auto thread : threads)
+		delete thread;
+}
+
+void Profiler::Init()
+{
+	// Timer queries need a GL context
+	gpuTiming = !Engine::IsHeadless();
+	if (gpuTiming)
+		CalibrateGPUClock();
+}
+
+// Offset between the GL timestamp clock and GetTime, used to place GPU passes on the CPU timeline
+void Profiler::CalibrateGPUClock()
+{
+	GLint64 gpuTime;
+	glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+	gpuClockOffset = GetTime() - gpuTime * 1e-6;
+}
+
+double Profiler::GetTime()
+{
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return (counter.QuadPart - timerStart.QuadPart) * timerPeriod;
+}
+
+unsigned int Profiler::GetFrameID() const
+{
+	return frameID;
+}
+
+ProfileThread* Profiler::GetThread()
+{
+	if (profileThread)
+		return profileThread;
+
+	profileThread = new ProfileThread();
+	profileThread->threadID = (unsigned short)JobSystem::GetThreadIndex();
+
+	// Keep the main thread first so its scopes lead the collected frame
+	lock_guard<mutex> guard(lock);
+	threads.push_back(profileThread);
+	sort(threads.begin(), threads.end(), [](const ProfileThread *a, const ProfileThread *b) {
+		return a->threadID < b->threadID;
+	});
+	return profileThread;
+}
+
+void Profiler::BeginScope(const char *name)
+{
+	ProfileThread *thread = GetThread();
+
+	ProfileEvent event;
+	event.name = name;
+	event.depth = (unsigned short)thread->stack.size();
+	event.threadID = thread->threadID;
+	event.end = 0;
+
+	lock_guard<mutex> guard(thread->lock);
+	thread->stack.push_back((unsigned int)thread->events.size());
+	event.start = GetTime();
+	thread->events.push_back(event);
+}
+
+void Profiler::EndScope()
+{
+	double time = GetTime();
+	ProfileThread *thread = GetThread();
+
+	lock_guard<mutex> guard(thread->lock);
+	if (thread->stack.empty())
+		return;
+	thread->events[thread->stack.back()].end = time;
+	thread->stack.pop_back();
+}
+
+GLuint Profiler::AcquireQuery()
+{
+	GLuint query;
+	if (freeQueries.empty()) {
+		glGenQueries(1, &query);
+		return query;
+	}
+	query = freeQueries.back();
+	freeQueries.pop_back();
+	return query;
+}
+
+void Profiler::BeginGPUScope(const char *name)
+{
+	if (!gpuTiming) return;
+
+	GPUFrame &frame = gpuFrames[frameID % GPU_LATENCY];
+
+	GPUQuery query;
+	query.name = name;
+	query.depth = (unsigned short)frame.stack.size();
+	query.begin = AcquireQuery();
+	query.end = 0;
+	glQueryCounter(query.begin, GL_TIMESTAMP);
+
+	frame.stack.push_back((unsigned int)frame.queries.size());
+	frame.queries.push_back(query);
+}
+
+void Profiler::EndGPUScope()
+{
+	if (!gpuTiming) return;
+
+	GPUFrame &frame = gpuFrames[frameID % GPU_LATENCY];
+	if (frame.stack.empty())
+		return;
+
+	GPUQuery &query = frame.queries[frame.stack.back()];
+	frame.stack.pop_back();
+	query.end = AcquireQuery();
+	glQueryCounter(query.end, GL_TIMESTAMP);
+}
+
+// Read back the queries issued GPU_LATENCY frames ago
+// Results that are still not available are dropped instead of stalling the pipeline
+void Profiler::ResolveGPUFrame(unsigned int slot)
+{
+	GPUFrame &frame = gpuFrames[slot];
+	if (frame.queries.empty())
+		return;
+
+	GLint available = 1;
+	const GPUQuery &lastQuery = frame.queries.back();
+	glGetQueryObjectiv(lastQuery.end ? lastQuery.end : lastQuery.begin, GL_QUERY_RESULT_AVAILABLE, &available);
+
+	ProfileFrame *target = nullptr;
+	if (available && frameID - frame.frameID < HISTORY_SIZE) {
+		target = &history[frame.frameID % HISTORY_SIZE];
+		if (target->frameID != frame.frameID)
+			target = nullptr;
+	}
+
+	bool capture = available && capturing && frame.frameID >= captureFirst && frame.frameID <= captureLast;
+
+	lock_guard<mutex> guard(lock);
+
+	for (auto &query : frame.queries) {
+		if ((target || capture) && query.end) {
+			// Timestamps are in nanoseconds
+			GLuint64 begin, end;
+			glGetQueryObjectui64v(query.begin, GL_QUERY_RESULT, &begin);
+			glGetQueryObjectui64v(query.end, GL_QUERY_RESULT, &end);
+
+			ProfileEvent event;
+			event.name = query.name;
+			event.start = begin * 1e-6 + gpuClockOffset;
+			event.end = end * 1e-6 + gpuClockOffset;
+			event.depth = query.depth;
+			event.threadID = GPU_THREAD;
+
+			if (target)
+				target->gpu.push_back(event);
+			if (capture)
+				captureEvents.push_back(event);
+		}
+
+		freeQueries.push_back(query.begin);
+		if (query.end)
+			freeQueries.push_back(query.end);
+	}
+
+	frame.queries.clear();
+	frame.stack.clear();
+}
+
+void Profiler::BeginFrame()
+{
+	frameID++;
+	frameStart = GetTime();
+
+	unsigned int slot = frameID % GPU_LATENCY;
+	if (gpuTiming)
+		ResolveGPUFrame(slot);
+	gpuFrames[slot].frameID = frameID;
+}
+
+void Profiler::EndFrame()
+{
+	lock_guard<mutex> guard(lock);
+
+	ProfileFrame &frame = history[frameID % HISTORY_SIZE];
+	frame.frameID = frameID;
+	frame.start = frameStart;
+	frame.end = GetTime();
+	frame.cpu.clear();
+	frame.gpu.clear();
+
+	for (auto thread : threads) {
+		lock_guard<mutex> threadGuard(thread->lock);
+
+		// Scopes still open (a job spanning the frame boundary) move to the next frame
+		unsigned int closed = thread->stack.empty() ? (unsigned int)thread->events.size() : thread->stack[0];
+		frame.cpu.insert(frame.cpu.end(), thread->events.begin(), thread->events.begin() + closed);
+		thread->events.erase(thread->events.begin(), thread->events.begin() + closed);
+		for (auto &index : thread->stack)
+			index -= closed;
+	}
+
+	if (historySize < HISTORY_SIZE)
+		historySize++;
+
+	if (!capturing)
+		return;
+
+	if (frameID >= captureFirst && frameID <= captureLast) {
+		captureFrames.push_back(frame);
+		captureFrames.back().cpu.clear();
+		captureEvents.insert(captureEvents.end(), frame.cpu.begin(), frame.cpu.end());
+	}
+
+	// Wait for the GPU results of the last captured frame
+	if (frameID >= captureLast + (gpuTiming ? GPU_LATENCY : 0)) {
+		WriteCapture();
+		capturing = false;
+		captureFrames.clear();
+		captureEvents.clear();
+	}
+}
+
+void Profiler::StartCapture(unsigned int nrFrames, const char *fileName)
+{
+#ifndef ENGINE_PROFILER
+	printf("Profiler: trace capture requires ENGINE_PROFILER\n");
+#else
+	lock_guard<mutex> guard(lock);
+	if (capturing || nrFrames == 0)
+		return;
+
+	if (gpuTiming)
+		CalibrateGPUClock();
+
+	capturing = true;
+	captureFirst = frameID + 1;
+	captureLast = frameID + nrFrames;
+	captureFile = fileName;
+	captureFrames.reserve(nrFrames);
+
+	printf("Profiler: capturing %u frames to %s\n", nrFrames, fileName);
+#endif
+}
+
+bool Profiler::IsCapturing() const
+{
+	return capturing;
+}
+
+static void WriteString(FILE *file, const char *value)
+{
+	fputc('"', file);
+	for (const char *c = value; *c; c++) {
+		if (*c == '"' || *c == '\\')
+			fputc('\\', file);
+		fputc(*c, file);
+	}
+	fputc('"', file);
+}
+
+// Chrome Trace Event format - complete events ("ph":"X") with timestamps in microseconds
+void Profiler::WriteCapture() const
+{
+	FILE *file = fopen(captureFile.c_str(), "w");
+	if (!file) {
+		printf("Profiler: could not write trace %s\n", captureFile.c_str());
+		return;
+	}
+
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	// Track names
+	fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Engine\"}}");
+	fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Main\"}}");
+	for (auto thread : threads) {
+		if (thread->threadID)
+			fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"Worker %u\"}}", thread->threadID, thread->threadID);
+	}
+	fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"GPU\"}}", GPU_THREAD);
+
+	for (auto &frame : captureFrames) {
+		fprintf(file, ",\n{\"name\":\"Frame %u\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":%.3lf,\"dur\":%.3lf}",
+			frame.frameID, frame.start * 1000, (frame.end - frame.start) * 1000);
+	}
+
+	for (auto &event : captureEvents) {
+		fprintf(file, ",\n{\"name\":");
+		WriteString(file, event.name);
+		fprintf(file, ",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3lf,\"dur\":%.3lf}",
+			event.threadID == GPU_THREAD ? "gpu" : "cpu", event.threadID, event.start * 1000, (event.end - event.start) * 1000);
+	}
+
+	fprintf(file, "\n]}\n");
+	fclose(file);
+
+	printf("Profiler: wrote %u frames (%u events) to %s\n", (unsigned int)captureFrames.size(), (unsigned int)captureEvents.size(), captureFile.c_str());
+}
+
+double Profiler::GetAverageFrameTime() const
+{
+	lock_guard<mutex> guard(lock);
+
+	if (!historySize)
+		return 0;
+
+	double total = 0;
+	for (unsigned int i = 0; i < historySize; i++) {
+		const ProfileFrame &frame = history[(frameID - i) % HISTORY_SIZE];
+		total += frame.end - frame.start;
+	}
+	return total / historySize;
+}
+
+void Profiler::GetStats(vector<ProfileStat> &stats) const
+{
+	stats.clear();
+
+	lock_guard<mutex> guard(lock);
+
+	// Scopes with the same name are summed per frame (one row per pass, not per call)
+	unordered_map<string, unsigned int> rows;
+	vector<double> frameSum;
+	vector<unsigned int> samples;
+
+	auto Accumulate = [&](const vector<ProfileEvent> &events, bool gpu) {
+		frameSum.assign(stats.size(), -1);
+		for (auto &event : events) {
+			string key = (gpu ? "G:" : "C:") + string(event.name);
+			auto row = rows.find(key);
+			unsigned int index;
+			if (row == rows.end()) {
+				index = (unsigned int)stats.size();
+				rows[key] = index;
+
+				ProfileStat stat;
+				stat.name = event.name;
+				stat.depth = event.depth;
+				stat.gpu = gpu;
+				stat.last = 0;
+				stat.average = 0;
+				stat.max = 0;
+				stats.push_back(stat);
+				samples.push_back(0);
+				frameSum.push_back(-1);
+			}
+			else {
+				index = row->second;
+			}
+			if (frameSum[index] < 0)
+				frameSum[index] = 0;
+			frameSum[index] += event.end - event.start;
+		}
+
+		for (unsigned int i = 0; i < frameSum.size(); i++) {
+			if (frameSum[i] < 0) continue;
+			ProfileStat &stat = stats[i];
+			if (!samples[i])
+				stat.last = frameSum[i];
+			stat.average += frameSum[i];
+			if (frameSum[i] > stat.max)
+				stat.max = frameSum[i];
+			samples[i]++;
+		}
+	};
+
+	// Newest frames first - row order and "last" follow the most recent frame
+	for (unsigned int i = 0; i < historySize; i++) {
+		const ProfileFrame &frame = history[(frameID - i) % HISTORY_SIZE];
+		Accumulate(frame.cpu, false);
+	}
+
+	// GPU results lag behind - "last" is the newest resolved frame
+	for (unsigned int i = 0; i < historySize; i++) {
+		const ProfileFrame &frame = history[(frameID - i) % HISTORY_SIZE];
+		Accumulate(frame.gpu, true);
+	}
+
+	for (unsigned int i = 0; i < stats.size(); i++) {
+		if (samples[i])
+			stats[i].average /= samples[i];
+	}
+}
+
+void Profiler::SetCounter(const char *name, unsigned int value)
+{
+	lock_guard<mutex> guard(lock);
+
+	for (auto &counter : counters) {
+		if (counter.name == name) {
+			counter.value = value;
+			return;
+		}
+	}
+
+	ProfileCounter counter;
+	counter.name = name;
+	counter.value = value;
+	counters.push_back(counter);
+}
+
+void Profiler::GetCounters(vector<ProfileCounter> &counters) const
+{
+	lock_guard<mutex> guard(lock);
+	counters = this->counters;
+}
+
+void Profiler::Count(const char *name, unsigned int value)
+{
+	Manager::GetProfiler()->SetCounter(name, value);
+}
+
+ProfileScope::ProfileScope(const char *name)
+{
+	Manager::GetProfiler()->BeginScope(name);
+}
+
+ProfileScope::~ProfileScope()
+{
+	Manager::GetProfiler()->EndScope();
+}
+
+GPUProfileScope::GPUProfileScope(const char *name)
+{
+	Manager::GetProfiler()->BeginGPUScope(name);
+}
+
+GPUProfileScope::~GPUProfileScope()
+{
+	Manager::GetProfiler()->EndGPUScope();
+}
@@ -0,0 +1,168 @@
+#pragma once
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <include/dll_export.h>
+#include <include/gl.h>
+
+using namespace std;
+
+/*
+ *	Scoped profiling markers and per frame counters
+ *	The name must be a string literal - only the pointer is recorded
+ *	Markers compile to nothing when ENGINE_PROFILER is not defined
+ */
+#ifdef ENGINE_PROFILER
+	#define PROFILE_CONCAT_IMPL(a, b)	a##b
+	#define PROFILE_CONCAT(a, b)		PROFILE_CONCAT_IMPL(a, b)
+	#define PROFILE_SCOPE(name)			ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+	#define PROFILE_GPU_SCOPE(name)		GPUProfileScope PROFILE_CONCAT(gpuProfileScope, __LINE__)(name)
+	#define PROFILE_COUNTER(name, value)	Profiler::Count(name, value)
+#else
+	#define PROFILE_SCOPE(name)
+	#define PROFILE_GPU_SCOPE(name)
+	#define PROFILE_COUNTER(name, value)
+#endif
+
+struct ProfileThread;
+
+struct ProfileEvent
+{
+	const char *name;
+	double start;				// ms since Profiler::Init
+	double end;
+	unsigned short depth;
+	unsigned short threadID;
+};
+
+struct ProfileFrame
+{
+	unsigned int frameID;
+	double start;
+	double end;
+	vector<ProfileEvent> cpu;
+	vector<ProfileEvent> gpu;	// filled a few frames later, when the queries are available
+};
+
+struct ProfileCounter
+{
+	const char *name;
+	unsigned int value;
+};
+
+struct ProfileStat
+{
+	const char *name;
+	unsigned int depth;
+	bool gpu;
+	double last;
+	double average;
+	double max;
+};
+
+/*
+ *	Hierarchical CPU/GPU frame profiler
+ *	CPU scopes are recorded per thread and collected at the end of the frame
+ *	GPU scopes use GL_TIMESTAMP queries and are resolved GPU_LATENCY frames later
+ *	The last HISTORY_SIZE frames are kept for aggregation
+ */
+class DLLExport Profiler
+{
+	public:
+		static const unsigned int HISTORY_SIZE = 120;
+		static const unsigned int GPU_LATENCY = 4;
+
+	protected:
+		Profiler();
+		~Profiler();
+
+	public:
+		void Init();
+		void BeginFrame();
+		void EndFrame();
+
+		void BeginScope(const char *name);
+		void EndScope();
+
+		// GPU scopes may only be used on the thread owning the GL context
+		void BeginGPUScope(const char *name);
+		void EndGPUScope();
+
+		// Per scope timings over the history - CPU rows first, in the order of the last frame
+		void GetStats(vector<ProfileStat> &stats) const;
+		double GetAverageFrameTime() const;
+		unsigned int GetFrameID() const;
+
+		// Values such as draw calls shown under the timings - the last value set is kept
+		// Count forwards to the engine profiler (see PROFILE_COUNTER)
+		void SetCounter(const char *name, unsigned int value);
+		void GetCounters(vector<ProfileCounter> &counters) const;
+		static void Count(const char *name, unsigned int value);
+
+		// Record the next nrFrames frames from all threads and write them to fileName
+		// as Chrome Trace Event JSON (chrome://tracing or ui.perfetto.dev)
+		// Started before the first frame the capture includes the startup loading
+		void StartCapture(unsigned int nrFrames, const char *fileName);
+		bool IsCapturing() const;
+
+		// Time in milliseconds since Init
+		static double GetTime();
+
+	private:
+		ProfileThread* GetThread();
+		GLuint AcquireQuery();
+		void ResolveGPUFrame(unsigned int slot);
+		void CalibrateGPUClock();
+		void WriteCapture() const;
+
+	private:
+		struct GPUQuery {
+			const char *name;
+			unsigned short depth;
+			GLuint begin;
+			GLuint end;
+		};
+
+		struct GPUFrame {
+			unsigned int frameID;
+			vector<GPUQuery> queries;
+			vector<unsigned int> stack;
+		};
+
+		unsigned int frameID;
+		double frameStart;
+		bool gpuTiming;
+		double gpuClockOffset;
+
+		mutable mutex lock;
+		vector<ProfileThread*> threads;
+		vector<ProfileFrame> history;
+		unsigned int historySize;
+		vector<ProfileCounter> counters;
+
+		GPUFrame gpuFrames[GPU_LATENCY];
+		vector<GLuint> freeQueries;
+
+		// Trace capture
+		bool capturing;
+		unsigned int captureFirst;
+		unsigned int captureLast;
+		string captureFile;
+		vector<ProfileFrame> captureFrames;
+		vector<ProfileEvent> captureEvents;
+};
+
+class DLLExport ProfileScope
+{
+	public:
+		ProfileScope(const char *name);
+		~ProfileScope();
+};
+
+class DLLExport GPUProfileScope
+{
+	public:
+		GPUProfileScope(const char *name);
+		~GPUProfileScope();
+};
@@ -3,6 +3,14 @@
 
 #include <include/gl.h>
 
+#include <Core/Engine.h>
+#include <GPU/RingBuffer.h>
+#include <GPU/Shader.h>
+#include <Manager/Profiler.h>
+
+// Bytes of each frame region of the ring - grown when a frame runs out
+static const unsigned int FRAME_DATA_SIZE = 4 << 20;
+
 //bool* RenderingSystem::states = nullptr;
 //bool* RenderingSystem::prevStates = nullptr;
 //int RenderingSystem::debugParam = 0;
@@ -11,6 +19,8 @@ void RenderingSystem::Init() {
 	debugParam = 0;
 	states = new bool[10]();
 	prevStates = new bool[10]();
+	frameData = new RingBuffer();
+	frameData->Init(FRAME_DATA_SIZE);
 	Set(RenderState::POST_PROCESS, true);
 	Set(RenderState::SHADOW, true);
 	Set(RenderState::SS_AO, false);
@@ -25,7 +35,7 @@ bool RenderingSystem::Is(RenderState STATE) {
 void RenderingSystem::Set(RenderState STATE, bool value) {
 	SavePreviousState(STATE);
 	states[STATE] = value;
-	if (STATE == RenderState::WIREFRAME)
+	if (STATE == RenderState::WIREFRAME && !Engine::IsHeadless())
 		value ? glPolygonMode(GL_FRONT_AND_BACK, GL_LINE) : glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 	UpdateGlobalState();
 }
@@ -42,6 +52,25 @@ bool RenderingSystem::Toggle(RenderState STATE) {
 	return states[STATE];
 }
 
+void RenderingSystem::BeginFrame() {
+	if (Engine::IsHeadless())
+		return;
+	frameData->BeginFrame();
+	frameData->BindTexture(GL_TEXTURE0 + FRAME_TEXTURE_UNIT);
+
+	// Total since startup - a growing value means the ring needs more frames in flight
+	PROFILE_COUNTER("Frame data stalls", frameData->GetStalls());
+}
+
+void RenderingSystem::EndFrame() {
+	if (!Engine::IsHeadless())
+		frameData->EndFrame();
+}
+
+RingBuffer* RenderingSystem::GetFrameData() const {
+	return frameData;
+}
+
 void RenderingSystem::UpdateGlobalState() {
 	states[RenderState::FORWARD] = false;
 	if (states[RenderState::WIREFRAME] || !states[RenderState::POST_PROCESS]) {
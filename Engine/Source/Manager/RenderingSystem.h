@@ -2,6 +2,8 @@
 
 #include <include/dll_export.h>
 
+class RingBuffer;
+
 using namespace std;
 
 namespace ERenderState {
@@ -28,6 +30,12 @@ class DLLExport RenderingSystem
 		void Revert(RenderState STATE);
 		bool Toggle(RenderState STATE);
 
+		// Bracket the GL work of a frame - data written to the frame ring is
+		// released once the GPU has finished the frame
+		void BeginFrame();
+		void EndFrame();
+		RingBuffer* GetFrameData() const;
+
 	private:
 		void UpdateGlobalState();
 		void SavePreviousState(RenderState STATE);
@@ -38,4 +46,5 @@ class DLLExport RenderingSystem
 	private:
 		bool *states;
 		bool *prevStates;
+		RingBuffer *frameData;
 };
\ No newline at end of file
@@ -11,8 +11,10 @@
 #include <Manager/SceneManager.h>
 #include <Manager/ShaderManager.h>
 #include <Manager/DebugInfo.h>
+#include <Manager/Profiler.h>
 
 #include <Core/GameObject.h>
+#include <Component/ComponentStore.h>
 #include <Component/Mesh.h>
 #include <Component/SkinnedMesh.h>
 #include <Component/Transform.h>
@@ -34,38 +36,47 @@ ResourceManager::~ResourceManager() {
 }
 
 void ResourceManager::Load(const char* file) {
+	PROFILE_SCOPE("Load Resources");
 	Manager::Debug->InitManager("Resources");
 
-	// Load document
-	const pugi::xml_document &doc = *(pugi::LoadXML(file));
+	CookedFile cooked;
+	if (!cooked.Load(file, CookedFile::RESOURCES)) {
+		cout << "Error: Resources could not be loaded => '" << file << "'" << endl;
+		return;
+	}
 
-	LoadMeshes(doc);
-	LoadGameObjects(doc);
-	LoadGameAudio(doc);
+	LoadMeshes(cooked);
+	LoadGameObjects(cooked);
+	LoadGameAudio(cooked);
 
 }
 
-void ResourceManager::LoadMeshes(const pugi::xml_document &doc)
+void ResourceManager::LoadMeshes(const CookedFile &file)
 {
-	const char* meshName;
-	pugi::xml_node meshesXML = doc.child("meshes");
+	unsigned int count;
+	auto records = file.GetTable<CookedFile::MeshRecord>(CookedFile::TABLE_MESHES, count);
 
-	for (pugi::xml_node mesh : meshesXML.children()) {
-		bool skinned = mesh.attribute("skinned").as_bool();
-		bool quad = mesh.attribute("quad").as_bool();
-		bool noMaterial = mesh.attribute("material") ? true : false;
+	for (unsigned int i = 0; i < count; i++) {
+		const CookedFile::MeshRecord &mesh = records[i];
+		const char *meshName = file.GetString(mesh.name);
 
-		meshName = mesh.child_value("name");
+		Mesh *M = (mesh.flags & CookedFile::FLAG_SKINNED) ? new SkinnedMesh(meshName) : new Mesh(meshName);
 
-		Mesh *M = skinned ? new SkinnedMesh(meshName) : new Mesh(meshName);
-
-		if (quad) {
+		if (mesh.flags & CookedFile::FLAG_QUAD) {
 			M->SetGlPrimitive(GL_QUADS);
 		}
-		if (noMaterial) {
+		if (mesh.flags & CookedFile::FLAG_NO_MATERIAL) {
 			M->UseMaterials(false);
 		}
-		if (!M->LoadMesh(RESOURCE_PATH::MODELS + mesh.child_value("path"), mesh.child_value("file"))) {
+
+		// Imported when a world partition cell needs them - skinned meshes load here
+		if ((mesh.flags & CookedFile::FLAG_STREAMED) && !(mesh.flags & CookedFile::FLAG_SKINNED)) {
+			M->SetStreamed(RESOURCE_PATH::MODELS + file.GetString(mesh.path), file.GetString(mesh.file));
+			meshes[meshName] = M;
+			continue;
+		}
+
+		if (!M->LoadMesh(RESOURCE_PATH::MODELS + file.GetString(mesh.path), file.GetString(mesh.file))) {
 			SAFE_FREE(M);
 			continue;
 		}
@@ -73,74 +84,65 @@ void ResourceManager::LoadMeshes(const pugi::xml_document &doc)
 	}
 }
 
-void ResourceManager::LoadGameAudio(const pugi::xml_document &doc)
+void ResourceManager::LoadGameAudio(const CookedFile &file)
 {
-	const char* audioName;
-	pugi::xml_node audiosXML = doc.child("audio");
+	unsigned int count, nrEffects;
+	auto records = file.GetTable<CookedFile::AudioRecord>(CookedFile::TABLE_AUDIO, count);
+	auto effects = file.GetTable<CookedFile::EffectRecord>(CookedFile::TABLE_EFFECTS, nrEffects);
 
-	for (pugi::xml_node audio : audiosXML.children()) {
-		cout << "Audio Type: " << audio.name() << endl;
+	for (unsigned int i = 0; i < count; i++) {
+		const CookedFile::AudioRecord &audio = records[i];
+		cout << "Audio Type: " << ((audio.flags & CookedFile::FLAG_MUSIC) ? "music" : "soundfx") << endl;
 
-		audioName = audio.child_value("name");
-		string fileLocation = RESOURCE_PATH::AUDIO + audio.child_value("path") + '\\' + audio.child_value("file");
+		const char *audioName = file.GetString(audio.name);
+		string fileLocation = RESOURCE_PATH::AUDIO + file.GetString(audio.path) + '\\' + file.GetString(audio.file);
 
-		if (strcmp(audio.name(), "music") == 0) {
+		if (audio.flags & CookedFile::FLAG_MUSIC) {
 			Manager::Audio->LoadAudio(fileLocation, audioName, AUDIO_TYPE::MUSIC);
 		}
 
-		if (strcmp(audio.name(), "soundfx") == 0) {
+		if (audio.flags & CookedFile::FLAG_SOUND_FX) {
 			Manager::Audio->LoadAudio(fileLocation, audioName, AUDIO_TYPE::SOUND_FX_FILE);
 
-			pugi::xml_node effectsXML = audio.child("effects");
-
-			for (pugi::xml_node fx : effectsXML.children()) {
-				const char* effectName = fx.child_value("name");
-				float offset = fx.child("start").text().as_float();
-				float length = fx.child("end").text().as_float() - offset;
-				Manager::Audio->InitSoundFX(audioName, effectName, offset, length);
+			for (unsigned int k = audio.firstEffect; k < audio.firstEffect + audio.nrEffects && k < nrEffects; k++) {
+				const CookedFile::EffectRecord &fx = effects[k];
+				Manager::Audio->InitSoundFX(audioName, file.GetString(fx.name), fx.start, fx.end - fx.start);
 			}
 
 		}
 	}
 }
 
-void ResourceManager::LoadGameObjects(const pugi::xml_document &doc)
+void ResourceManager::LoadGameObjects(const CookedFile &file)
 {
-	const char *objName;
-	const char* meshName;
-	pugi::xml_node shaderInfo;
-	pugi::xml_node physicsInfo;
-	pugi::xml_node transformInfo;
-	pugi::xml_node renderingInfo;
-	pugi::xml_node objects = doc.child("objects");
-
-	for (pugi::xml_node obj : objects.children()) {
-		objName = obj.child_value("name");
-		meshName = obj.child_value("mesh");
-		shaderInfo = obj.child("shader");
-		physicsInfo = obj.child("physics");
-		transformInfo = obj.child("transform");
-		renderingInfo = obj.child("shadow");
+	unsigned int count;
+	auto records = file.GetTable<CookedFile::ObjectRecord>(CookedFile::TABLE_OBJECTS, count);
+
+	for (unsigned int i = 0; i < count; i++) {
+		const CookedFile::ObjectRecord &obj = records[i];
+		const char *objName = file.GetString(obj.name);
 
 		GameObject *GO = new GameObject(objName);
-		SetTransform(transformInfo, *GO->transform);
-		if (meshName) {
-			GO->mesh = meshes[meshName];
+		GO->staticObject = (obj.flags & CookedFile::FLAG_STATIC) != 0;
+		GO->occluder = (obj.flags & CookedFile::FLAG_OCCLUDER) != 0;
+		SetTransform(obj.transform, *GO->transform);
+		if (obj.mesh != CookedFile::NO_STRING) {
+			GO->mesh = meshes[file.GetString(obj.mesh)];
 			GO->SetupAABB();
 		}
 
-		if (shaderInfo) {
-			GO->UseShader(Manager::Shader->GetShader(shaderInfo.text().get()));
+		if (obj.shader != CookedFile::NO_STRING) {
+			GO->UseShader(Manager::Shader->GetShader(file.GetString(obj.shader)));
 		}
 
 		#ifdef PHYSICS_ENGINE
-		if (physicsInfo) {
+		if (obj.physics != CookedFile::NO_STRING) {
 			GO->physics = new Physics(GO);
-			GO->physics->LoadHavokFile(RESOURCE_PATH::PHYSICS + physicsInfo.child_value("file"));
+			GO->physics->LoadHavokFile(RESOURCE_PATH::PHYSICS + file.GetString(obj.physics));
 		}
 		#endif
 
-		if (renderingInfo) {
+		if (obj.flags & CookedFile::FLAG_SHADOW) {
 			GO->renderer->SetCastShadow(true);
 		}
 
@@ -154,6 +156,67 @@ GameObject* ResourceManager::GetGameObject(const char *name) {
 	return nullptr;
 }
 
+const GameObject* ResourceManager::GetPrefab(const char *name) const {
+	auto prefab = _objects.find(name);
+	return prefab != _objects.end() ? prefab->second : nullptr;
+}
+
+GameObject* ResourceManager::Instantiate(const char *name) {
+	auto prefab = _objects.find(name);
+	if (prefab == _objects.end() || prefab->second == nullptr)
+		return nullptr;
+
+	// A released object may still be waiting for the scene to remove it
+	auto &pool = _pool[name];
+	if (!pool.empty() && !Manager::Scene->GetActiveObject(pool.back()->GetSceneHandle())) {
+		GameObject *obj = pool.back();
+		pool.pop_back();
+		ResetInstance(obj, prefab->second);
+		return obj;
+	}
+
+	return new GameObject(*prefab->second);
+}
+
+void ResourceManager::Instantiate(const char *name, unsigned int count, vector<GameObject*> &objects) {
+	PROFILE_SCOPE("Instantiate");
+	objects.reserve(objects.size() + count);
+
+	// Transform and bounding volume entity for every new copy
+	auto &pool = _pool[name];
+	unsigned int newObjects = count > pool.size() ? count - (unsigned int)pool.size() : 0;
+	Manager::GetComponents()->Reserve(2 * newObjects);
+
+	for (unsigned int i = 0; i < count; i++) {
+		GameObject *obj = Instantiate(name);
+		if (obj == nullptr)
+			return;
+		objects.push_back(obj);
+	}
+}
+
+void ResourceManager::Release(GameObject *obj) {
+	if (obj->pooled || obj->refID == nullptr)
+		return;
+	obj->pooled = true;
+	_pool[obj->refID].push_back(obj);
+}
+
+// Bring a released object back to the prefab state
+void ResourceManager::ResetInstance(GameObject *obj, const GameObject *prefab) {
+	obj->pooled = false;
+	obj->staticObject = prefab->staticObject;
+	obj->transform->position = prefab->transform->position;
+	obj->transform->rotationQ = prefab->transform->rotationQ;
+	obj->transform->scale = prefab->transform->scale;
+	obj->transform->Update();
+
+	#ifdef PHYSICS_ENGINE
+	if (obj->physics)
+		obj->physics->ResetVelocity();
+	#endif
+}
+
 unsigned int ResourceManager::GetGameObjectUID(const char *name)
 {
 	if (name == nullptr) return -1;
@@ -164,25 +227,18 @@ unsigned int ResourceManager::GetGameObjectUID(const char *name)
 	return _counter[name];
 }
 
-void ResourceManager::SetTransform(pugi::xml_node node, Transform &T) {
-	if (!node)
+void ResourceManager::SetTransform(const CookedFile::TransformRecord &record, Transform &T) {
+	if (!record.fields)
 		return;
 
-	pugi::xml_node prop;
-
-	prop = node.child("position");
-	if (prop)
-		T.position = glm::ExtractVector<glm::vec3>(prop.text().get());
+	if (record.fields & CookedFile::FIELD_POSITION)
+		T.position = glm::make_vec3(record.position);
 
-	prop = node.child("rotation");
-	if (prop) {
-		glm::vec3 rotation = glm::ExtractVector<glm::vec3>(prop.text().get());
-		T.SetRotation(rotation);
-	}
+	if (record.fields & CookedFile::FIELD_ROTATION)
+		T.SetRotation(glm::make_vec3(record.rotation));
 
-	prop = node.child("scale");
-	if (prop)
-		T.scale = glm::ExtractVector<glm::vec3>(prop.text().get());
+	if (record.fields & CookedFile::FIELD_SCALE)
+		T.scale = glm::make_vec3(record.scale);
 
 	T.Update();
 }
\ No newline at end of file
@@ -1,8 +1,9 @@
 #pragma once
 #include <unordered_map>
+#include <vector>
 
 #include <include/dll_export.h>
-#include <include/pugixml.h>
+#include <Core/CookedFile.h>
 
 using namespace std;
 
@@ -27,19 +28,31 @@ class DLLExport ResourceManager
 		~ResourceManager();
 
 	public:
+		// Resources are read from the cooked form of the XML file (see CookedFile)
 		void Load(const char *file);
-		void LoadMeshes(const pugi::xml_document &doc);
-		void LoadGameObjects(const pugi::xml_document &doc);
-		void LoadGameAudio(const pugi::xml_document &doc);
+		void LoadMeshes(const CookedFile &file);
+		void LoadGameObjects(const CookedFile &file);
+		void LoadGameAudio(const CookedFile &file);
 
 		GameObject* GetGameObject(const char *name);
 		unsigned int GetGameObjectUID(const char *name);
+		const GameObject* GetPrefab(const char *name) const;
+
+		// Pooled prefab instances - released objects are reused before new copies are made
+		// Objects must be removed from the scene before they are released
+		GameObject* Instantiate(const char *name);
+		void Instantiate(const char *name, unsigned int count, vector<GameObject*> &objects);
+		void Release(GameObject *obj);
 
 	public:
-		void SetTransform(pugi::xml_node node, Transform &T);
+		void SetTransform(const CookedFile::TransformRecord &record, Transform &T);
+
+	private:
+		void ResetInstance(GameObject *obj, const GameObject *prefab);
 
 	private:
 		unordered_map<string, GameObject*> _objects;
+		unordered_map<string, vector<GameObject*>> _pool;
 		unordered_map<string, unsigned int> _counter;
 		unordered_map<string, Mesh*> meshes;
 };
\ No newline at end of file
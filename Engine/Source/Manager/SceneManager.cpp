@@ -1,124 +1,448 @@
 //#include <pch.h>
 #include "SceneManager.h"
 
+#include <cstring>
 #include <iostream>
 
 #ifdef PHYSICS_ENGINE
 #include <Component/Physics.h>
 #endif
+#include <Component/AABB.h>
 #include <Component/AudioSource.h>
+#include <Component/Mesh.h>
+#include <Component/ComponentStore.h>
+#include <Component/Renderer.h>
 #include <Component/Transform.h>
 
 #include <Core/Camera/Camera.h>
+#include <Core/CookedFile.h>
 #include <Core/GameObject.h>
 
 #include <Lighting/PointLight.h>
 
+#include <Utils/3D.h>
+
 #include <Manager/Manager.h>
 #include <Manager/AudioManager.h>
 #include <Manager/ResourceManager.h>
 #include <Manager/DebugInfo.h>
 #include <Manager/EventSystem.h>
+#include <Manager/Profiler.h>
 
 SceneManager::SceneManager() {
+	dynamicChanged = false;
+	occlusionCulling = true;
+	occludedObjects = 0;
+	occlusionCuller.Init(256, 128);
 }
 
 SceneManager::~SceneManager() {
 }
 
 void SceneManager::LoadScene(const char *fileName) {
+	PROFILE_SCOPE("Load Scene");
 	Manager::Debug->InitManager("Scene");
 	sceneFile = fileName;
 
+	// Streamed objects go back to the pools
+	partition.Clear();
+
+	for (auto obj : activeObjects) {
+		RegisterComponents(obj, false);
+		IndexBounds(obj, false);
+	}
+
 	frustumObjects.clear();
-	activeObjects.clear();
+	visibleVolumes.clear();
+	for (auto &bucket : objectIndex)
+		bucket.clear();
+	activeObjects.Clear();		// handles of the previous scene objects become stale
+	dynamicObjects.clear();
+	dynamicChanged = false;
 	lights.clear();
 	toRemove.clear();
+	sceneInstances.clear();
 
-	// Load document
-	pugi::xml_document &doc = *pugi::LoadXML(fileName);
+	// Load the cooked scene - the XML file is cooked again when it changes
+	// The data stays loaded for streaming the scene cells
+	if (!sceneData.Load(fileName, CookedFile::SCENE)) {
+		cout << "Error: Scene could not be loaded => '" << fileName << "'" << endl;
+		return;
+	}
 
 	// TODO
 	// Load different type of objects based on container
 	// examples - lights, coins, etc
-	// const char *container = child.name();
 
 	// --- Load GameObjects --- //
-	const char *refID;
-	pugi::xml_node audioInfo;
-	pugi::xml_node transformInfo;
-	pugi::xml_node objects = doc.child("objects");
-
-	for (pugi::xml_node obj: objects.children()) {
-		refID	= obj.child_value("ref");
-		transformInfo = obj.child("transform");
-		audioInfo = obj.child("audio");
-
-		GameObject *GO = Manager::Resource->GetGameObject(refID);
-		if (GO == nullptr) {
-			cout << "Error: Resource game-object not found => '" << refID << "'" << endl;
-			continue;
-		}
-		Manager::Resource->SetTransform(transformInfo, *GO->transform);
-
-		if (audioInfo) {
-			bool loop = audioInfo.attribute("loop").as_bool();
-			pugi::xml_attribute att = audioInfo.attribute("volume");
-			GO->SetAudioSource(Manager::Audio->GetAudioSource(audioInfo.text().get()));
-			GO->audioSource->SetLoop(loop);
-			if (!att.empty())
-				GO->audioSource->SetVolume(att.as_float());
-		}
+	unsigned int count;
+	if (sceneData.GetHeader()->cellSize > 0) {
+		partition.Init(&sceneData);
+	}
+	else {
+		auto objects = sceneData.GetTable<CookedFile::InstanceRecord>(CookedFile::TABLE_INSTANCES, count);
+		for (unsigned int i = 0; i < count; i++) {
+			SceneInstance entry;
+			entry.object = SpawnInstance(sceneData, objects[i]);
+			entry.record = objects[i];
+			entry.audio = objects[i].audio != CookedFile::NO_STRING ? sceneData.GetString(objects[i].audio) : "";
+			sceneInstances[sceneData.GetString(objects[i].ref)].push_back(entry);
 
-		AddObject(GO);
+			if (entry.object)
+				AddObject(entry.object);
+		}
 	}
 
 	// --- Load Lights --- //
-	pugi::xml_node pointLights = doc.child("lights");
-
-	for (pugi::xml_node light: pointLights.children()) {
-		transformInfo = light.child("transform");
-		auto area = light.child("area").text().as_float();
+	auto pointLights = sceneData.GetTable<CookedFile::LightRecord>(CookedFile::TABLE_LIGHTS, count);
 
+	for (unsigned int i = 0; i < count; i++) {
 		auto *L = new PointLight();
-		L->SetArea(area);
-		Manager::Resource->SetTransform(transformInfo, *L->light->transform);
+		L->SetArea(pointLights[i].area);
+		Manager::Resource->SetTransform(pointLights[i].transform, *L->light->transform);
 
 		this->lights.push_back(L);
 	}
 }
 
-// TODO - bug clear Physics World... just loaded objects
+GameObject* SceneManager::SpawnInstance(const CookedFile &file, const CookedFile::InstanceRecord &record) {
+	const char *refID = file.GetString(record.ref);
+
+	GameObject *GO = Manager::Resource->Instantiate(refID);
+	if (GO == nullptr) {
+		cout << "Error: Resource game-object not found => '" << refID << "'" << endl;
+		return nullptr;
+	}
+	Manager::Resource->SetTransform(record.transform, *GO->transform);
+
+	// Scene entries can override the resource classification
+	if (record.flags & CookedFile::FLAG_HAS_STATIC)
+		SetStatic(GO, (record.flags & CookedFile::FLAG_STATIC) != 0);
+
+	if (record.audio != CookedFile::NO_STRING) {
+		GO->SetAudioSource(Manager::Audio->GetAudioSource(file.GetString(record.audio)));
+		GO->audioSource->SetLoop((record.flags & CookedFile::FLAG_AUDIO_LOOP) != 0);
+		if (record.flags & CookedFile::FLAG_AUDIO_VOLUME)
+			GO->audioSource->SetVolume(record.volume);
+	}
+
+	return GO;
+}
+
+// Entries are compared by value - string offsets differ between cooked files
+static bool SameInstance(const CookedFile::InstanceRecord &a, const string &audioA,
+						 const CookedFile::InstanceRecord &b, const string &audioB)
+{
+	return a.flags == b.flags && a.volume == b.volume && audioA == audioB
+		&& memcmp(&a.transform, &b.transform, sizeof(CookedFile::TransformRecord)) == 0;
+}
+
 void SceneManager::ReloadScene() {
-	LoadScene(sceneFile);
+	PROFILE_SCOPE("Reload Scene");
+
+	CookedFile cooked;
+	if (!cooked.Load(sceneFile, CookedFile::SCENE)) {
+		cout << "Error: Scene could not be loaded => '" << sceneFile << "'" << endl;
+		return;
+	}
+
+	// Streamed scenes own their objects through the partition
+	if (partition.IsEnabled() || cooked.GetHeader()->cellSize > 0) {
+		LoadScene(sceneFile);
+		return;
+	}
+
+	unsigned int count;
+	unsigned int added = 0, patched = 0, removed = 0;
+	unordered_map<string, vector<SceneInstance>> instances;
+
+	auto objects = cooked.GetTable<CookedFile::InstanceRecord>(CookedFile::TABLE_INSTANCES, count);
+	for (unsigned int i = 0; i < count; i++) {
+		const char *refID = cooked.GetString(objects[i].ref);
+		auto &entries = instances[refID];
+
+		SceneInstance entry;
+		entry.object = nullptr;
+		entry.record = objects[i];
+		entry.audio = objects[i].audio != CookedFile::NO_STRING ? cooked.GetString(objects[i].audio) : "";
+
+		// Same refID and position among its entries => same object
+		auto previous = sceneInstances.find(refID);
+		if (previous != sceneInstances.end() && entries.size() < previous->second.size()) {
+			SceneInstance &match = previous->second[entries.size()];
+			entry.object = match.object;
+			match.object = nullptr;
+
+			// Objects released by the game meanwhile are created again
+			if (entry.object && entry.object->pooled)
+				entry.object = nullptr;
+
+			if (entry.object && !SameInstance(match.record, match.audio, entry.record, entry.audio)) {
+				PatchInstance(entry.object, cooked, entry.record);
+				patched++;
+			}
+		}
+
+		if (entry.object == nullptr) {
+			entry.object = SpawnInstance(cooked, entry.record);
+			if (entry.object) {
+				AddObject(entry.object);
+				if (entry.object->audioSource)
+					entry.object->audioSource->Play();
+				added++;
+			}
+		}
+
+		entries.push_back(entry);
+	}
+
+	// Entries missing from the new file - removing them also takes them out of the physics world
+	for (auto &ref : sceneInstances) {
+		for (auto &entry : ref.second) {
+			if (entry.object == nullptr || entry.object->pooled)
+				continue;
+			entry.object->SetAudioSource(nullptr);
+			RemoveObject(entry.object);
+			Manager::Resource->Release(entry.object);
+			removed++;
+		}
+	}
+
+	sceneInstances.swap(instances);
+	sceneData = cooked;
+
+	// Lights are matched by their order in the file
+	auto pointLights = sceneData.GetTable<CookedFile::LightRecord>(CookedFile::TABLE_LIGHTS, count);
+	for (size_t i = count; i < lights.size(); i++)
+		delete lights[i];
+	if (count < lights.size())
+		lights.resize(count);
+	for (unsigned int i = 0; i < count; i++) {
+		if (i == lights.size())
+			lights.push_back(new PointLight());
+		lights[i]->SetArea(pointLights[i].area);
+		Manager::Resource->SetTransform(pointLights[i].transform, *lights[i]->light->transform);
+	}
+
+	cout << "Scene reloaded => added: " << added << ", changed: " << patched << ", removed: " << removed << endl;
+}
+
+// Bring a scene object to a changed entry - fields missing from the entry use the resource values
+void SceneManager::PatchInstance(GameObject *obj, const CookedFile &file, const CookedFile::InstanceRecord &record) {
+	const GameObject *prefab = Manager::Resource->GetPrefab(obj->refID);
+	if (prefab) {
+		obj->transform->position = prefab->transform->position;
+		obj->transform->rotationQ = prefab->transform->rotationQ;
+		obj->transform->scale = prefab->transform->scale;
+	}
+	Manager::Resource->SetTransform(record.transform, *obj->transform);
+	obj->transform->Update();
+
+	// Moved, not animated - don't interpolate from the old placement
+	obj->transform->SaveState();
+
+	#ifdef PHYSICS_ENGINE
+	// Physics::Update copies the body back onto the transform - move the body along
+	if (obj->physics) {
+		obj->physics->RemoveFromWorld();
+		obj->physics->AddToWorld();
+		obj->physics->ResetVelocity();
+	}
+	#endif
+
+	bool value = prefab ? prefab->staticObject : obj->staticObject;
+	if (record.flags & CookedFile::FLAG_HAS_STATIC)
+		value = (record.flags & CookedFile::FLAG_STATIC) != 0;
+	SetStatic(obj, value);
+
+	// A replaced or dropped source is stopped, a new one starts like the scene audio does
+	AudioSource *previous = obj->audioSource;
+	AudioSource *source = nullptr;
+	if (record.audio != CookedFile::NO_STRING)
+		source = Manager::Audio->GetAudioSource(file.GetString(record.audio));
+	obj->SetAudioSource(source);
+
+	if (source) {
+		source->SetLoop((record.flags & CookedFile::FLAG_AUDIO_LOOP) != 0);
+		if (record.flags & CookedFile::FLAG_AUDIO_VOLUME)
+			source->SetVolume(record.volume);
+		if (source != previous)
+			source->Play();
+	}
+
+	RefitObject(obj);
+}
+
+void SceneManager::StreamAround(const glm::vec3 &viewer) {
+	partition.Update(viewer);
+	ApplyChanges();
 }
 
 void SceneManager::Update() {
+	ApplyChanges();
+
+	UpdateDynamicObjects();
+	for (auto obj : dynamicObjects) {
+		obj->Update();
+	}
+}
+
+// Objects added and removed since the last call enter or leave the active set
+void SceneManager::ApplyChanges() {
 	bool shouldAdd = !toAdd.empty();
 	bool shouldRemove = !toRemove.empty();
 
 	if (shouldAdd || shouldRemove) {
 		if (shouldAdd) {
 			for (auto obj: toAdd) {
-				activeObjects.push_back(obj);
+				if (activeObjects.IsValid(obj->sceneHandle))
+					continue;
+				obj->transform->SaveState();
+				RegisterComponents(obj, true);
+				IndexObject(obj, true);
+				IndexBounds(obj, true);
+				obj->sceneHandle = activeObjects.Insert(obj);
+
+				// Static objects are only updated once, when they enter the scene
+				if (obj->staticObject)
+					obj->Update();
 			}
 			toAdd.clear();
+			dynamicChanged = true;
 		}
 
 		if (shouldRemove) {
 			for (auto obj: toRemove) {
-				auto elem = find(activeObjects.begin(), activeObjects.end(), obj);
-				activeObjects.remove(obj);
+				// Already removed or never added
+				if (!activeObjects.Remove(obj->sceneHandle))
+					continue;
+				RegisterComponents(obj, false);
+				IndexObject(obj, false);
+				IndexBounds(obj, false);
 			}
+			activeObjects.Compact();
 			toRemove.clear();
+			dynamicChanged = true;
 		}
 	}
+}
+
+void SceneManager::UpdateDynamicObjects() {
+	if (!dynamicChanged)
+		return;
 
+	dynamicObjects.clear();
 	for (auto obj : activeObjects) {
-		obj->Update();
+		if (!obj->staticObject)
+			dynamicObjects.push_back(obj);
+	}
+	dynamicChanged = false;
+}
+
+// Flag the object's entities so the ComponentStore sweeps pick them up
+void SceneManager::RegisterComponents(GameObject *obj, bool active) {
+	auto store = Manager::GetComponents();
+	EntityID entity = obj->GetEntity();
+
+	store->SetFlags(entity, ENTITY_SIMULATED, active);
+	store->SetFlags(entity, ENTITY_STATIC | ENTITY_DIRTY, active && obj->staticObject);
+	store->SetFlags(entity, ENTITY_CAST_SHADOW, active && obj->renderer && obj->renderer->CastShadow());
+	store->SetFlags(entity, ENTITY_VISIBLE, false);
+	store->SetOwner(entity, active ? obj : nullptr);
+
+	if (obj->aabb) {
+		EntityID bounds = obj->aabb->transform->entity;
+		store->SetBoundsTarget(bounds, entity);
+		store->SetFlags(bounds, ENTITY_BOUNDS, active);
+		store->SetFlags(bounds, ENTITY_STATIC | ENTITY_DIRTY, active && obj->staticObject);
+		store->SetFlags(bounds, ENTITY_VISIBLE, false);
+		store->SetOwner(bounds, active ? obj : nullptr);
+	}
+}
+
+// Keep the (refID, instanceID) => object index in sync with the active objects
+void SceneManager::IndexObject(GameObject *obj, bool active) {
+	if (obj->refID == nullptr)
+		return;
+
+	auto ref = refIDs.find(obj->refID);
+	if (ref == refIDs.end()) {
+		if (!active) return;
+		unsigned int id = (unsigned int)objectIndex.size();
+		auto name = sortedRefIDs.insert(make_pair(string(obj->refID), id)).first;
+		ref = refIDs.insert(make_pair(name->first.c_str(), id)).first;
+		objectIndex.push_back(unordered_map<unsigned int, GameObject*>());
+	}
+
+	if (active)
+		objectIndex[ref->second][obj->instanceID] = obj;
+	else
+		objectIndex[ref->second].erase(obj->instanceID);
+}
+
+// Keep the object's world box in the BVH of its partition
+void SceneManager::IndexBounds(GameObject *obj, bool active) {
+	if (!obj->aabb)
+		return;
+
+	BVH &tree = obj->staticObject ? staticTree : dynamicTree;
+	if (active) {
+		if (obj->spatialProxy != BVH::NULL_NODE)
+			return;
+		glm::vec3 min, max;
+		Manager::GetComponents()->GetWorldBounds(obj->aabb->transform->entity, min, max);
+		obj->spatialProxy = tree.Insert(obj, min, max);
+	}
+	else if (obj->spatialProxy != BVH::NULL_NODE) {
+		tree.Remove(obj->spatialProxy);
+		obj->spatialProxy = BVH::NULL_NODE;
+	}
+}
+
+void SceneManager::SetStatic(GameObject *obj, bool value) {
+	if (obj->staticObject == value)
+		return;
+
+	bool indexed = obj->spatialProxy != BVH::NULL_NODE;
+	if (indexed)
+		IndexBounds(obj, false);
+	obj->staticObject = value;
+	if (indexed)
+		IndexBounds(obj, true);
+
+	if (activeObjects.IsValid(obj->sceneHandle)) {
+		RegisterComponents(obj, true);
+		dynamicChanged = true;
 	}
 }
 
+void SceneManager::RefitObject(GameObject *obj) {
+	if (obj->spatialProxy == BVH::NULL_NODE)
+		return;
+
+	// Cached model and bounds are rebuilt by the next sweeps
+	if (obj->staticObject) {
+		auto store = Manager::GetComponents();
+		store->SetFlags(obj->GetEntity(), ENTITY_DIRTY, true);
+		store->SetFlags(obj->aabb->transform->entity, ENTITY_DIRTY, true);
+	}
+
+	glm::vec3 min, max;
+	Manager::GetComponents()->GetWorldBounds(obj->aabb->transform->entity, min, max);
+	(obj->staticObject ? staticTree : dynamicTree).Move(obj->spatialProxy, min, max);
+}
+
+// Snapshot transforms before a simulation tick
+void SceneManager::SaveState() {
+	Manager::GetComponents()->SaveState();
+}
+
+// Rebuild model matrices between the previous and current simulation tick
+void SceneManager::InterpolateState(float alpha) {
+	PROFILE_SCOPE("Interpolate State");
+	Manager::GetComponents()->Interpolate(alpha);
+}
+
 void SceneManager::AddObject(GameObject *obj) {
 	toAdd.push_back(obj);
 	#ifdef PHYSICS_ENGINE
@@ -135,20 +459,177 @@ void SceneManager::RemoveObject(GameObject *obj) {
 	#endif
 }
 
-GameObject* SceneManager::GetObject(char *refID, unsigned int instanceID)
+GameObject* SceneManager::GetObject(const char *refID, unsigned int instanceID)
 {
-	for (auto obj : activeObjects) {
-		if (obj->instanceID == instanceID &&
-			strcmp(obj->refID, refID) == 0)
-			return obj;
+	auto ref = refIDs.find(refID);
+	if (ref == refIDs.end())
+		return nullptr;
+
+	auto &bucket = objectIndex[ref->second];
+	auto obj = bucket.find(instanceID);
+	return obj != bucket.end() ? obj->second : nullptr;
+}
+
+void SceneManager::FindObjects(const char *prefix, vector<GameObject*> &objects) const
+{
+	size_t length = strlen(prefix);
+	for (auto ref = sortedRefIDs.lower_bound(prefix); ref != sortedRefIDs.end(); ref++) {
+		if (ref->first.compare(0, length, prefix) != 0)
+			break;
+		for (auto &obj : objectIndex[ref->second])
+			objects.push_back(obj.second);
 	}
-	return nullptr;
 }
 
+GameObject* SceneManager::GetActiveObject(SlotHandle handle) const
+{
+	auto obj = activeObjects.Get(handle);
+	return obj ? *obj : nullptr;
+}
+
+/*
+ *	The camera volume is a box in the light space, open toward the light so that
+ *	shadow casters outside the view are kept - BVH nodes are tested in that space
+ *	and the leaves with the exact light space volume of the object
+ */
 void SceneManager::FrustumCulling(Camera *camera) {
+	if (!camera->aabb) return;
+
+	auto store = Manager::GetComponents();
+	EntityID volume = camera->aabb->transform->entity;
+
+	store->SetVolumeFlags(visibleVolumes, ENTITY_VISIBLE | ENTITY_IN_VIEW, false);
+	visibleVolumes.clear();
 	frustumObjects.clear();
-	for (auto obj: activeObjects) {
-		if (camera->ColidesWith(obj))
+
+	glm::quat toSpace = glm::inverse(store->Rotation(volume));
+	glm::mat3 R = glm::mat3_cast(toSpace);
+	glm::vec3 center = R * store->Position(volume);
+	glm::vec3 half = store->Scale(volume) * 0.5f;
+
+	auto test = [&R, &center, &half](const glm::vec3 &min, const glm::vec3 &max) {
+		glm::vec3 h = (max - min) * 0.5f;
+		glm::vec3 extent;
+		for (int k = 0; k < 3; k++)
+			extent[k] = fabs(R[0][k]) * h.x + fabs(R[1][k]) * h.y + fabs(R[2][k]) * h.z;
+
+		glm::vec3 delta = center - R * ((min + max) * 0.5f);
+		return fabs(delta.x) < half.x + extent.x && delta.y < half.y + extent.y && fabs(delta.z) < half.z + extent.z;
+	};
+
+	auto visit = [this, store, volume](GameObject *obj) {
+		EntityID bounds = obj->aabb->transform->entity;
+		if (store->Overlaps(volume, bounds)) {
+			visibleVolumes.push_back(bounds);
 			frustumObjects.push_back(obj);
+		}
+	};
+
+	staticTree.Query(test, visit);
+	dynamicTree.Query(test, visit);
+
+	store->SetVolumeFlags(visibleVolumes, ENTITY_VISIBLE, true);
+
+	// The volume above keeps the shadow casters - flag the objects actually
+	// inside the camera frustum with the packed plane kernel
+	PROFILE_SCOPE("View Frustum");
+	glm::vec3 min, max;
+	viewCuller.Clear();
+	for (auto bounds : visibleVolumes) {
+		store->GetWorldBounds(bounds, min, max);
+		viewCuller.Add((min + max) * 0.5f, (max - min) * 0.5f);
+	}
+
+	glm::vec4 planes[6];
+	glm::mat4 viewProjection = camera->Projection * camera->View;
+	Utils3D::ExtractFrustumPlanes(viewProjection, planes);
+	viewCuller.Cull(planes, inView);
+
+	occludedObjects = 0;
+	if (occlusionCulling)
+		OcclusionCulling(viewProjection);
+
+	inViewVolumes.clear();
+	for (auto index : inView)
+		inViewVolumes.push_back(visibleVolumes[index]);
+	store->SetVolumeFlags(inViewVolumes, ENTITY_IN_VIEW, true);
+}
+
+// Rasterize the occluders in view and drop the objects behind them from inView
+// Occluded objects keep ENTITY_VISIBLE since their shadows can still be in view
+void SceneManager::OcclusionCulling(const glm::mat4 &viewProjection) {
+	PROFILE_SCOPE("Occlusion Culling");
+	occlusionCuller.Begin(viewProjection);
+
+	for (auto index : inView) {
+		GameObject *obj = frustumObjects[index];
+		if (!obj->occluder || !obj->mesh)
+			continue;
+
+		auto mesh = occluderMeshes.find(obj->mesh);
+		if (mesh == occluderMeshes.end()) {
+			mesh = occluderMeshes.insert(make_pair(obj->mesh, vector<glm::vec3>())).first;
+			obj->mesh->GetTriangles(mesh->second);
+		}
+		occlusionCuller.RenderOccluder(obj->transform->model, mesh->second);
 	}
+	occlusionCuller.BuildHierarchy();
+
+	auto store = Manager::GetComponents();
+	glm::vec3 min, max;
+	unsigned int count = 0;
+	for (auto index : inView) {
+		store->GetWorldBounds(visibleVolumes[index], min, max);
+		if (occlusionCuller.IsVisible(min, max))
+			inView[count++] = index;
+	}
+	occludedObjects = (unsigned int)inView.size() - count;
+	inView.resize(count);
+}
+
+void SceneManager::SetOcclusionCulling(bool value) {
+	occlusionCulling = value;
+}
+
+unsigned int SceneManager::GetOccludedCount() const {
+	return occludedObjects;
+}
+
+// Refit the dynamic BVH and recompute the objects' AABB in the space given by rotationQ
+void SceneManager::UpdateBoundingBoxes(glm::quat rotationQ) {
+	auto store = Manager::GetComponents();
+	{
+		PROFILE_SCOPE("Refit BVH");
+		glm::vec3 min, max;
+		UpdateDynamicObjects();
+		for (auto obj : dynamicObjects) {
+			if (obj->spatialProxy == BVH::NULL_NODE)
+				continue;
+			store->GetWorldBounds(obj->aabb->transform->entity, min, max);
+			dynamicTree.Move(obj->spatialProxy, min, max);
+		}
+	}
+	store->UpdateBounds(rotationQ);
+}
+
+void SceneManager::QueryBox(const glm::vec3 &min, const glm::vec3 &max, vector<GameObject*> &objects) const {
+	staticTree.QueryBox(min, max, objects);
+	dynamicTree.QueryBox(min, max, objects);
+}
+
+void SceneManager::QuerySphere(const glm::vec3 &center, float radius, vector<GameObject*> &objects) const {
+	staticTree.QuerySphere(center, radius, objects);
+	dynamicTree.QuerySphere(center, radius, objects);
+}
+
+void SceneManager::QueryFrustum(const glm::mat4 &viewProjection, vector<GameObject*> &objects) const {
+	glm::vec4 planes[6];
+	Utils3D::ExtractFrustumPlanes(viewProjection, planes);
+	staticTree.QueryFrustum(planes, objects);
+	dynamicTree.QueryFrustum(planes, objects);
+}
+
+void SceneManager::QueryRay(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, vector<GameObject*> &objects) const {
+	staticTree.QueryRay(origin, direction, maxDistance, objects);
+	dynamicTree.QueryRay(origin, direction, maxDistance, objects);
 }
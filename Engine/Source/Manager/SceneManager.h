@@ -1,13 +1,26 @@
 #pragma once
-#include <list>
+#include <cstring>
+#include <map>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <include/dll_export.h>
+#include <include/glm.h>
 #include <include/pugixml.h>
+#include <templates/slot_map.h>
+
+#include <Component/ComponentStore.h>
+#include <Core/BVH.h>
+#include <Core/CookedFile.h>
+#include <Core/WorldPartition.h>
+#include <Rendering/FrustumCuller.h>
+#include <Rendering/OcclusionCuller.h>
 
 class PointLight;
 class GameObject;
 class Camera;
+class Mesh;
 
 using namespace std;
 
@@ -19,22 +32,124 @@ class DLLExport SceneManager
 
 	public:
 		void LoadScene(const char *fileName);
+
+		// Apply the changes of the scene file to the live scene
+		// Entries are matched by refID and their order among the entries of that refID:
+		// only new, removed or edited entries touch the scene
 		void ReloadScene();
+
+		// Load and unload the cells of a partitioned scene around the viewer
+		// Per frame, outside the simulation - the cell objects enter or leave the scene
+		// right away, so the next extracted packet no longer references unloaded ones
+		void StreamAround(const glm::vec3 &viewer);
+
+		// New object for a scene entry - it still has to be added to the scene
+		GameObject* SpawnInstance(const CookedFile &file, const CookedFile::InstanceRecord &record);
 			 
 		void Update();
+		void SaveState();
+		void InterpolateState(float alpha);
 		void FrustumCulling(Camera *camera);
+
+		// Objects hidden behind the occluders are dropped from the camera view (not from the shadows)
+		void SetOcclusionCulling(bool value);
+		unsigned int GetOccludedCount() const;
+		void UpdateBoundingBoxes(glm::quat rotationQ);
 		void AddObject(GameObject *obj);
 		void RemoveObject(GameObject *obj);
-		GameObject* GetObjectW(char *refID, unsigned int instanceID);
+		GameObject* GetObjectW(const char *refID, unsigned int instanceID);
+
+		// Active objects whose refID starts with prefix
+		void FindObjects(const char *prefix, vector<GameObject*> &objects) const;
+
+		// Active object of a handle or nullptr if the object has left the scene
+		GameObject* GetActiveObject(SlotHandle handle) const;
+
+		// Static objects live in their own BVH and are skipped by the per-frame updates
+		// Objects are static if their resource or scene entry says so
+		// RefitObject must be called after moving a static object
+		void SetStatic(GameObject *obj, bool value);
+		void RefitObject(GameObject *obj);
+
+		// Spatial queries over the world boxes of the active objects
+		void QueryBox(const glm::vec3 &min, const glm::vec3 &max, vector<GameObject*> &objects) const;
+		void QuerySphere(const glm::vec3 &center, float radius, vector<GameObject*> &objects) const;
+		void QueryFrustum(const glm::mat4 &viewProjection, vector<GameObject*> &objects) const;
+		void QueryRay(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, vector<GameObject*> &objects) const;
+
+	private:
+		void RegisterComponents(GameObject *obj, bool active);
+		void IndexObject(GameObject *obj, bool active);
+		void IndexBounds(GameObject *obj, bool active);
+		void UpdateDynamicObjects();
+		void ApplyChanges();
+		void OcclusionCulling(const glm::mat4 &viewProjection);
+		void PatchInstance(GameObject *obj, const CookedFile &file, const CookedFile::InstanceRecord &record);
+
+	private:
+		// Object created for a scene entry
+		struct SceneInstance {
+			GameObject *object;
+			CookedFile::InstanceRecord record;
+			string audio;
+		};
+
+		// FNV-1a over the refID characters - lookups hash the caller's string in place
+		struct RefIDHash {
+			size_t operator()(const char *name) const {
+				size_t hash = 2166136261u;
+				for (; *name; name++)
+					hash = (hash ^ (unsigned char)*name) * 16777619u;
+				return hash;
+			}
+		};
+
+		struct RefIDEqual {
+			bool operator()(const char *a, const char *b) const {
+				return strcmp(a, b) == 0;
+			}
+		};
 
 	private:
 		const char *sceneFile;
-		list<GameObject*> toAdd;
-		list<GameObject*> toRemove;
+		CookedFile sceneData;
+		WorldPartition partition;
+
+		// Entries of the scene file per refID, in file order - empty for partitioned scenes
+		unordered_map<string, vector<SceneInstance>> sceneInstances;
+		vector<GameObject*> toAdd;
+		vector<GameObject*> toRemove;
+
+		// Active objects that are not static - rebuilt when the active set changes
+		vector<GameObject*> dynamicObjects;
+		bool dynamicChanged;
+
+		// Lookup index - refIDs are interned to a bucket of instanceID => object
+		// The hashed keys point to the names owned by sortedRefIDs (never erased),
+		// so GetObject does not build a string per lookup
+		unordered_map<const char*, unsigned int, RefIDHash, RefIDEqual> refIDs;
+		map<string, unsigned int> sortedRefIDs;
+		vector<unordered_map<unsigned int, GameObject*>> objectIndex;
+
+		// Spatial index - static and dynamic partitions
+		BVH staticTree;
+		BVH dynamicTree;
+		vector<EntityID> visibleVolumes;
+
+		// Camera frustum test of the visible volumes
+		FrustumCuller viewCuller;
+		vector<unsigned int> inView;
+		vector<EntityID> inViewVolumes;
+
+		// CPU depth buffer test of the objects in view
+		OcclusionCuller occlusionCuller;
+		unordered_map<const Mesh*, vector<glm::vec3>> occluderMeshes;
+		bool occlusionCulling;
+		unsigned int occludedObjects;
 
 	public:
 		vector<PointLight*> lights;
-		list<GameObject*> activeObjects;
-		list<GameObject*> frustumObjects;
+		SlotMap<GameObject*> activeObjects;
+		vector<GameObject*> frustumObjects;
 
 };
\ No newline at end of file
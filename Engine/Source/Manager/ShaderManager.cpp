@@ -12,6 +12,7 @@
 #include <GPU/Shader.h>
 #include <Manager/DebugInfo.h>
 #include <Manager/Manager.h>
+#include <Manager/Profiler.h>
 
 static const string _PATH("Resources\\Shaders\\");
 
@@ -24,6 +25,7 @@ ShaderManager::~ShaderManager() {
 }
 
 void ShaderManager::Load(const char *file) {
+	PROFILE_SCOPE("Load Shaders");
 	Manager::Debug->InitManager("Shaders");
 
 	pugi::xml_document *doc = pugi::LoadXML(file);
@@ -7,6 +7,7 @@
 
 #include <Manager/Manager.h>
 #include <Manager/DebugInfo.h>
+#include <Manager/Profiler.h>
 #include <Manager/ResourceManager.h>
 
 TextureManager::TextureManager() {
@@ -35,9 +36,11 @@ Texture* TextureManager::LoadTexture(const string &path, const char *fileName) {
 	Texture *texture = GetTexture(fileName);
 
 	if (texture) {
-		return mapTextures[fileName];
+		return texture;
 	}
 
+	PROFILE_SCOPE("Load Texture");
+
 	texture = new Texture();
 	bool rc = texture->Load2D((path + '\\' + fileName).c_str());
 
@@ -46,14 +49,26 @@ Texture* TextureManager::LoadTexture(const string &path, const char *fileName) {
 		return vTextures[0];
 	}
 
-	vTextures.push_back(texture);
-	mapTextures[fileName] = texture;
+	AddTexture(fileName, texture);
 	return texture;
 }
 
+void TextureManager::AddTexture(const char *name, Texture *texture) {
+	lock_guard<mutex> guard(lock);
+	vTextures.push_back(texture);
+	mapTextures[name] = texture;
+}
+
+bool TextureManager::IsLoaded(const char *name) const {
+	lock_guard<mutex> guard(lock);
+	return mapTextures.find(name) != mapTextures.end();
+}
+
+// Lookups do not insert - jobs may read the map through IsLoaded meanwhile
 Texture* TextureManager::GetTexture(const char* name) {
-	if (mapTextures[name])
-		return mapTextures[name];
+	auto texture = mapTextures.find(name);
+	if (texture != mapTextures.end())
+		return texture->second;
 	return NULL;
 }
 
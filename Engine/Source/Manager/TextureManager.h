@@ -1,5 +1,6 @@
 #pragma once
 
+#include <mutex>
 #include <unordered_map>
 #include <string>
 #include <vector>
@@ -18,12 +19,17 @@ class DLLExport TextureManager
 		Texture* GetTexture(unsigned int textureID);
 		void Init();
 
+		// Textures are only added on the main thread - IsLoaded may be called from jobs
+		void AddTexture(const char *name, Texture *texture);
+		bool IsLoaded(const char *name) const;
+
 	protected:
 		TextureManager();
 		~TextureManager();
 
 	private:
 
+		mutable mutex lock;
 		unordered_map<string, Texture*> mapTextures;
 		vector<Texture*> vTextures;
 };
\ No newline at end of file
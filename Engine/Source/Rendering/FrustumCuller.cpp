@@ -0,0 +1,229 @@
+//#include <pch.h>
+#include "FrustumCuller.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef __AVX__
+#include <immintrin.h>
+#else
+#include <xmmintrin.h>
+#endif
+
+#include <Manager/Profiler.h>
+#include <Utils/3D.h>
+
+FrustumCuller::FrustumCuller()
+{
+}
+
+FrustumCuller::~FrustumCuller()
+{
+}
+
+void FrustumCuller::Clear()
+{
+	centerX.clear();
+	centerY.clear();
+	centerZ.clear();
+	extentX.clear();
+	extentY.clear();
+	extentZ.clear();
+}
+
+void FrustumCuller::Reserve(unsigned int size)
+{
+	centerX.reserve(size);
+	centerY.reserve(size);
+	centerZ.reserve(size);
+	extentX.reserve(size);
+	extentY.reserve(size);
+	extentZ.reserve(size);
+}
+
+unsigned int FrustumCuller::Add(const glm::vec3 &center, const glm::vec3 &extent)
+{
+	centerX.push_back(center.x);
+	centerY.push_back(center.y);
+	centerZ.push_back(center.z);
+	extentX.push_back(extent.x);
+	extentY.push_back(extent.y);
+	extentZ.push_back(extent.z);
+	return (unsigned int)centerX.size() - 1;
+}
+
+unsigned int FrustumCuller::GetSize() const
+{
+	return (unsigned int)centerX.size();
+}
+
+// A box is outside when it lies fully behind one of the planes
+bool FrustumCuller::IsVisible(const glm::vec4 planes[6], unsigned int i) const
+{
+	for (int p = 0; p < 6; p++) {
+		const glm::vec4 &P = planes[p];
+		// same operation order as the SIMD kernel so both give identical results
+		float d = (P.x * centerX[i] + P.y * centerY[i]) + (P.z * centerZ[i] + P.w);
+		float r = (fabs(P.x) * extentX[i] + fabs(P.y) * extentY[i]) + fabs(P.z) * extentZ[i];
+		if (d + r < 0)
+			return false;
+	}
+	return true;
+}
+
+void FrustumCuller::CullScalar(const glm::vec4 planes[6], vector<unsigned int> &visible) const
+{
+	visible.clear();
+	unsigned int size = GetSize();
+	for (unsigned int i = 0; i < size; i++) {
+		if (IsVisible(planes, i))
+			visible.push_back(i);
+	}
+}
+
+/*
+ *	Every lane computes d + r for a plane and the lane masks are combined over the
+ *	six planes - a group stops early once all its boxes are outside a plane
+ *	Indices are compacted without branches: each one is always written and the
+ *	output only advances for visible lanes
+ */
+void FrustumCuller::Cull(const glm::vec4 planes[6], vector<unsigned int> &visible) const
+{
+	unsigned int size = GetSize();
+	visible.resize(size + 8);
+	unsigned int *out = visible.data();
+	unsigned int count = 0;
+	unsigned int i = 0;
+
+	#ifdef __AVX__
+	const unsigned int LANES = 8;
+	__m256 px[6], py[6], pz[6], pw[6], ax[6], ay[6], az[6];
+	for (int p = 0; p < 6; p++) {
+		px[p] = _mm256_set1_ps(planes[p].x);
+		py[p] = _mm256_set1_ps(planes[p].y);
+		pz[p] = _mm256_set1_ps(planes[p].z);
+		pw[p] = _mm256_set1_ps(planes[p].w);
+		ax[p] = _mm256_set1_ps(fabs(planes[p].x));
+		ay[p] = _mm256_set1_ps(fabs(planes[p].y));
+		az[p] = _mm256_set1_ps(fabs(planes[p].z));
+	}
+	const __m256 zero = _mm256_setzero_ps();
+
+	for (; i + LANES <= size; i += LANES) {
+		__m256 cx = _mm256_loadu_ps(&centerX[i]);
+		__m256 cy = _mm256_loadu_ps(&centerY[i]);
+		__m256 cz = _mm256_loadu_ps(&centerZ[i]);
+		__m256 ex = _mm256_loadu_ps(&extentX[i]);
+		__m256 ey = _mm256_loadu_ps(&extentY[i]);
+		__m256 ez = _mm256_loadu_ps(&extentZ[i]);
+
+		int mask = 0xFF;
+		for (int p = 0; p < 6 && mask; p++) {
+			__m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px[p], cx), _mm256_mul_ps(py[p], cy)),
+									 _mm256_add_ps(_mm256_mul_ps(pz[p], cz), pw[p]));
+			__m256 r = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ax[p], ex), _mm256_mul_ps(ay[p], ey)),
+									 _mm256_mul_ps(az[p], ez));
+			mask &= _mm256_movemask_ps(_mm256_cmp_ps(_mm256_add_ps(d, r), zero, _CMP_GE_OQ));
+		}
+
+		for (unsigned int k = 0; k < LANES; k++) {
+			out[count] = i + k;
+			count += (mask >> k) & 1;
+		}
+	}
+	#else
+	const unsigned int LANES = 4;
+	__m128 px[6], py[6], pz[6], pw[6], ax[6], ay[6], az[6];
+	for (int p = 0; p < 6; p++) {
+		px[p] = _mm_set1_ps(planes[p].x);
+		py[p] = _mm_set1_ps(planes[p].y);
+		pz[p] = _mm_set1_ps(planes[p].z);
+		pw[p] = _mm_set1_ps(planes[p].w);
+		ax[p] = _mm_set1_ps(fabs(planes[p].x));
+		ay[p] = _mm_set1_ps(fabs(planes[p].y));
+		az[p] = _mm_set1_ps(fabs(planes[p].z));
+	}
+	const __m128 zero = _mm_setzero_ps();
+
+	for (; i + LANES <= size; i += LANES) {
+		__m128 cx = _mm_loadu_ps(&centerX[i]);
+		__m128 cy = _mm_loadu_ps(&centerY[i]);
+		__m128 cz = _mm_loadu_ps(&centerZ[i]);
+		__m128 ex = _mm_loadu_ps(&extentX[i]);
+		__m128 ey = _mm_loadu_ps(&extentY[i]);
+		__m128 ez = _mm_loadu_ps(&extentZ[i]);
+
+		int mask = 0xF;
+		for (int p = 0; p < 6 && mask; p++) {
+			__m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px[p], cx), _mm_mul_ps(py[p], cy)),
+								  _mm_add_ps(_mm_mul_ps(pz[p], cz), pw[p]));
+			__m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax[p], ex), _mm_mul_ps(ay[p], ey)),
+								  _mm_mul_ps(az[p], ez));
+			mask &= _mm_movemask_ps(_mm_cmpge_ps(_mm_add_ps(d, r), zero));
+		}
+
+		for (unsigned int k = 0; k < LANES; k++) {
+			out[count] = i + k;
+			count += (mask >> k) & 1;
+		}
+	}
+	#endif
+
+	// remaining boxes
+	for (; i < size; i++) {
+		out[count] = i;
+		count += IsVisible(planes, i) ? 1 : 0;
+	}
+
+	visible.resize(count);
+}
+
+static float RandomFloat(float min, float max)
+{
+	return min + (max - min) * (rand() / (float)RAND_MAX);
+}
+
+void FrustumCuller::Benchmark(unsigned int nrBoxes)
+{
+	const unsigned int ITERATIONS = 100;
+
+	FrustumCuller culler;
+	culler.Reserve(nrBoxes);
+	for (unsigned int i = 0; i < nrBoxes; i++) {
+		glm::vec3 center(RandomFloat(-500, 500), RandomFloat(-20, 20), RandomFloat(-500, 500));
+		glm::vec3 extent(RandomFloat(0.1f, 4), RandomFloat(0.1f, 4), RandomFloat(0.1f, 4));
+		culler.Add(center, extent);
+	}
+
+	glm::mat4 View = glm::lookAt(glm::vec3(0, 10, 0), glm::vec3(1, 10, 1), glm::vec3(0, 1, 0));
+	glm::mat4 Projection = glm::perspective(60.0f, 16.0f / 9.0f, 0.1f, 300.0f);
+	glm::vec4 planes[6];
+	Utils3D::ExtractFrustumPlanes(Projection * View, planes);
+
+	vector<unsigned int> visible;
+	vector<unsigned int> reference;
+	culler.Cull(planes, visible);
+	culler.CullScalar(planes, reference);
+
+	double start = Profiler::GetTime();
+	for (unsigned int i = 0; i < ITERATIONS; i++)
+		culler.CullScalar(planes, reference);
+	double scalarTime = (Profiler::GetTime() - start) / ITERATIONS;
+
+	start = Profiler::GetTime();
+	for (unsigned int i = 0; i < ITERATIONS; i++)
+		culler.Cull(planes, visible);
+	double simdTime = (Profiler::GetTime() - start) / ITERATIONS;
+
+	#ifdef __AVX__
+	const char *kernel = "AVX";
+	#else
+	const char *kernel = "SSE";
+	#endif
+
+	printf("\nFrustum culling benchmark - %u boxes, %u visible%s\n", nrBoxes, (unsigned int)visible.size(),
+		visible == reference ? "" : " (MISMATCH with the scalar kernel)");
+	printf("\tScalar: %.3f ms (%.1f Mboxes/s)\n", scalarTime, nrBoxes / (scalarTime * 1000));
+	printf("\t%s:    %.3f ms (%.1f Mboxes/s) - x%.2f\n\n", kernel, simdTime, nrBoxes / (simdTime * 1000), scalarTime / simdTime);
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <vector>
+
+#include <include/dll_export.h>
+#include <include/glm.h>
+
+using namespace std;
+
+/*
+ *	Frustum culling kernel over packed bounds
+ *	Boxes are stored as separate center/extent component arrays so the planes
+ *	are tested against 4 (SSE) or 8 (AVX builds) boxes at a time
+ *	Planes come from Utils3D::ExtractFrustumPlanes (normals pointing inside)
+ */
+class DLLExport FrustumCuller
+{
+	public:
+		FrustumCuller();
+		~FrustumCuller();
+
+		void Clear();
+		void Reserve(unsigned int size);
+		unsigned int Add(const glm::vec3 &center, const glm::vec3 &extent);
+		unsigned int GetSize() const;
+
+		// Writes the indices of the boxes intersecting the frustum, in increasing order
+		void Cull(const glm::vec4 planes[6], vector<unsigned int> &visible) const;
+		void CullScalar(const glm::vec4 planes[6], vector<unsigned int> &visible) const;
+
+		// Time both kernels over nrBoxes random boxes and print the throughput
+		static void Benchmark(unsigned int nrBoxes);
+
+	private:
+		bool IsVisible(const glm::vec4 planes[6], unsigned int index) const;
+
+	private:
+		vector<float> centerX;
+		vector<float> centerY;
+		vector<float> centerZ;
+		vector<float> extentX;
+		vector<float> extentY;
+		vector<float> extentZ;
+};
@@ -0,0 +1,57 @@
+//#include <pch.h>
+#include "InstanceBuffer.h"
+
+#include <GPU/RingBuffer.h>
+
+#include <Manager/Manager.h>
+#include <Manager/RenderingSystem.h>
+
+InstanceBuffer::InstanceBuffer()
+{
+	baseInstance = 0;
+}
+
+InstanceBuffer::~InstanceBuffer()
+{
+}
+
+void InstanceBuffer::Clear()
+{
+	data.clear();
+	baseInstance = 0;
+}
+
+unsigned int InstanceBuffer::Add(const glm::mat4 &model, const glm::vec4 &color)
+{
+	data.push_back(model[0]);
+	data.push_back(model[1]);
+	data.push_back(model[2]);
+	data.push_back(model[3]);
+	data.push_back(color);
+	return (unsigned int)data.size() / INSTANCE_SIZE - 1;
+}
+
+unsigned int InstanceBuffer::GetSize() const
+{
+	return (unsigned int)data.size() / INSTANCE_SIZE;
+}
+
+bool InstanceBuffer::Upload()
+{
+	if (data.empty())
+		return false;
+
+	unsigned int stride = INSTANCE_SIZE * sizeof(glm::vec4);
+	unsigned int size = (unsigned int)(data.size() * sizeof(glm::vec4));
+	unsigned int offset = Manager::GetRenderSys()->GetFrameData()->Write(data.data(), size, stride);
+	if (offset == RingBuffer::INVALID_OFFSET)
+		return false;
+
+	baseInstance = offset / stride;
+	return true;
+}
+
+unsigned int InstanceBuffer::GetBaseInstance() const
+{
+	return baseInstance;
+}
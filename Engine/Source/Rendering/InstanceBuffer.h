@@ -0,0 +1,39 @@
+#pragma once
+#include <vector>
+
+#include <include/dll_export.h>
+#include <include/gl.h>
+#include <include/glm.h>
+
+using namespace std;
+
+/*
+ *	Per-object data of a pass read by the vertex shaders through the frame ring buffer
+ *	An instance is INSTANCE_SIZE vec4: the model matrix columns, then a color
+ *	Shaders fetch instance (instance_offset + gl_InstanceID) from instance_data
+ *	when the instanced uniform is set - instance_offset counts from GetBaseInstance
+ *	The ring texture stays bound to FRAME_TEXTURE_UNIT for the whole frame
+ */
+class DLLExport InstanceBuffer
+{
+	public:
+		static const unsigned int INSTANCE_SIZE = 5;
+		// GL 4.1 guarantees 65536 texels for a buffer texture
+		static const unsigned int MAX_INSTANCES = 65536 / INSTANCE_SIZE;
+
+	public:
+		InstanceBuffer();
+		~InstanceBuffer();
+
+		void Clear();
+		unsigned int Add(const glm::mat4 &model, const glm::vec4 &color = glm::vec4(0));
+		unsigned int GetSize() const;
+
+		// Copy the instances to the frame ring - false when the frame is out of space
+		bool Upload();
+		unsigned int GetBaseInstance() const;
+
+	private:
+		unsigned int baseInstance;
+		vector<glm::vec4> data;
+};
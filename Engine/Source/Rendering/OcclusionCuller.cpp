@@ -0,0 +1,295 @@
+//#include <pch.h>
+#include "OcclusionCuller.h"
+
+#include <algorithm>
+#include <cmath>
+#include <xmmintrin.h>
+
+#include <Manager/Profiler.h>
+
+OcclusionCuller::OcclusionCuller()
+{
+	width = 0;
+	height = 0;
+}
+
+OcclusionCuller::~OcclusionCuller()
+{
+}
+
+void OcclusionCuller::Init(unsigned int width, unsigned int height)
+{
+	this->width = (width + 3) & ~3u;
+	this->height = height;
+
+	levels.clear();
+	unsigned int w = this->width;
+	unsigned int h = height;
+	while (true) {
+		Level level;
+		level.width = w;
+		level.height = h;
+		level.depth.resize(w * h, 1.0f);
+		levels.push_back(level);
+		if (w == 1 && h == 1)
+			break;
+		w = (w + 1) / 2;
+		h = (h + 1) / 2;
+	}
+}
+
+void OcclusionCuller::Begin(const glm::mat4 &viewProjection)
+{
+	this->viewProjection = viewProjection;
+	if (levels.empty())
+		return;
+
+	vector<float> &depth = levels[0].depth;
+	fill(depth.begin(), depth.end(), 1.0f);
+}
+
+void OcclusionCuller::RenderOccluder(const glm::mat4 &model, const vector<glm::vec3> &triangles)
+{
+	if (levels.empty())
+		return;
+
+	glm::mat4 MVP = viewProjection * model;
+	for (size_t i = 0; i + 3 <= triangles.size(); i += 3) {
+		glm::vec4 v0 = MVP * glm::vec4(triangles[i], 1);
+		glm::vec4 v1 = MVP * glm::vec4(triangles[i + 1], 1);
+		glm::vec4 v2 = MVP * glm::vec4(triangles[i + 2], 1);
+
+		// Distance to the near plane is z + w in clip space
+		int behind = (v0.z + v0.w < 0 ? 1 : 0) + (v1.z + v1.w < 0 ? 1 : 0) + (v2.z + v2.w < 0 ? 1 : 0);
+		if (behind == 3)
+			continue;
+		if (behind)
+			RasterizeClipped(v0, v1, v2);
+		else
+			RasterizeTriangle(v0, v1, v2);
+	}
+}
+
+// Cut the triangle with the near plane - the part in front is a triangle or a quad
+void OcclusionCuller::RasterizeClipped(const glm::vec4 &v0, const glm::vec4 &v1, const glm::vec4 &v2)
+{
+	const glm::vec4 *in[3] = { &v0, &v1, &v2 };
+	glm::vec4 out[4];
+	unsigned int count = 0;
+
+	for (int i = 0; i < 3; i++) {
+		const glm::vec4 &a = *in[i];
+		const glm::vec4 &b = *in[(i + 1) % 3];
+		float da = a.z + a.w;
+		float db = b.z + b.w;
+
+		if (da >= 0)
+			out[count++] = a;
+		if ((da >= 0) != (db >= 0))
+			out[count++] = a + (b - a) * (da / (da - db));
+	}
+
+	for (unsigned int i = 2; i < count; i++)
+		RasterizeTriangle(out[0], out[i - 1], out[i]);
+}
+
+/*
+ *	Edge functions are evaluated at the pixel centers of 4 pixels at once
+ *	Window depth is affine in screen space, so it is interpolated with the
+ *	same edge values - covered pixels keep the nearest depth
+ */
+void OcclusionCuller::RasterizeTriangle(const glm::vec4 &v0, const glm::vec4 &v1, const glm::vec4 &v2)
+{
+	if (v0.w <= 0 || v1.w <= 0 || v2.w <= 0)
+		return;
+
+	glm::vec3 p[3];
+	const glm::vec4 *v[3] = { &v0, &v1, &v2 };
+	for (int i = 0; i < 3; i++) {
+		float invW = 1.0f / v[i]->w;
+		p[i].x = (v[i]->x * invW * 0.5f + 0.5f) * width;
+		p[i].y = (v[i]->y * invW * 0.5f + 0.5f) * height;
+		p[i].z = v[i]->z * invW * 0.5f + 0.5f;
+	}
+
+	float minX = p[0].x < p[1].x ? p[0].x : p[1].x;
+	float maxX = p[0].x > p[1].x ? p[0].x : p[1].x;
+	float minY = p[0].y < p[1].y ? p[0].y : p[1].y;
+	float maxY = p[0].y > p[1].y ? p[0].y : p[1].y;
+	minX = p[2].x < minX ? p[2].x : minX;
+	maxX = p[2].x > maxX ? p[2].x : maxX;
+	minY = p[2].y < minY ? p[2].y : minY;
+	maxY = p[2].y > maxY ? p[2].y : maxY;
+
+	if (maxX < 0 || maxY < 0 || minX >= width || minY >= height)
+		return;
+
+	int x0 = minX > 0 ? (int)minX : 0;
+	int y0 = minY > 0 ? (int)minY : 0;
+	int x1 = maxX < width - 1 ? (int)maxX : width - 1;
+	int y1 = maxY < height - 1 ? (int)maxY : height - 1;
+	x0 &= ~3;
+
+	// E(p) = A * x + B * y + C for the edge opposite to each vertex
+	float A[3], B[3], C[3];
+	for (int i = 0; i < 3; i++) {
+		const glm::vec3 &a = p[(i + 1) % 3];
+		const glm::vec3 &b = p[(i + 2) % 3];
+		A[i] = a.y - b.y;
+		B[i] = b.x - a.x;
+		C[i] = a.x * b.y - a.y * b.x;
+	}
+
+	float area = A[2] * p[2].x + B[2] * p[2].y + C[2];
+	if (fabs(area) < 1e-6f)
+		return;
+
+	// Occluders are double sided
+	if (area < 0) {
+		for (int i = 0; i < 3; i++) {
+			A[i] = -A[i];
+			B[i] = -B[i];
+			C[i] = -C[i];
+		}
+		area = -area;
+	}
+
+	float dz1 = (p[1].z - p[0].z) / area;
+	float dz2 = (p[2].z - p[0].z) / area;
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 laneOffset = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+	const __m128 z0 = _mm_set1_ps(p[0].z);
+	const __m128 Z1 = _mm_set1_ps(dz1);
+	const __m128 Z2 = _mm_set1_ps(dz2);
+	__m128 stepX[3], a[3];
+	for (int i = 0; i < 3; i++) {
+		a[i] = _mm_set1_ps(A[i]);
+		stepX[i] = _mm_set1_ps(A[i] * 4);
+	}
+
+	float *depth = levels[0].depth.data();
+	for (int y = y0; y <= y1; y++) {
+		float py = y + 0.5f;
+		__m128 px = _mm_add_ps(_mm_set1_ps((float)x0), laneOffset);
+		__m128 e[3];
+		for (int i = 0; i < 3; i++)
+			e[i] = _mm_add_ps(_mm_mul_ps(a[i], px), _mm_set1_ps(B[i] * py + C[i]));
+
+		float *row = depth + y * width;
+		for (int x = x0; x <= x1; x += 4) {
+			__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e[0], zero), _mm_cmpge_ps(e[1], zero)), _mm_cmpge_ps(e[2], zero));
+			if (_mm_movemask_ps(inside)) {
+				__m128 z = _mm_add_ps(z0, _mm_add_ps(_mm_mul_ps(e[1], Z1), _mm_mul_ps(e[2], Z2)));
+				__m128 old = _mm_loadu_ps(row + x);
+				__m128 nearest = _mm_min_ps(old, z);
+				_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, old)));
+			}
+			for (int i = 0; i < 3; i++)
+				e[i] = _mm_add_ps(e[i], stepX[i]);
+		}
+	}
+}
+
+// Every texel keeps the farthest depth of the texels it covers on the level below
+void OcclusionCuller::BuildHierarchy()
+{
+	PROFILE_SCOPE("Occlusion Hierarchy");
+	for (size_t k = 1; k < levels.size(); k++) {
+		const Level &src = levels[k - 1];
+		Level &dst = levels[k];
+		for (unsigned int y = 0; y < dst.height; y++) {
+			unsigned int sy0 = y * 2;
+			unsigned int sy1 = sy0 + 1 < src.height ? sy0 + 1 : sy0;
+			for (unsigned int x = 0; x < dst.width; x++) {
+				unsigned int sx0 = x * 2;
+				unsigned int sx1 = sx0 + 1 < src.width ? sx0 + 1 : sx0;
+				float a = src.depth[sy0 * src.width + sx0];
+				float b = src.depth[sy0 * src.width + sx1];
+				float c = src.depth[sy1 * src.width + sx0];
+				float d = src.depth[sy1 * src.width + sx1];
+				a = a > b ? a : b;
+				c = c > d ? c : d;
+				dst.depth[y * dst.width + x] = a > c ? a : c;
+			}
+		}
+	}
+}
+
+bool OcclusionCuller::IsVisible(const glm::vec3 &min, const glm::vec3 &max) const
+{
+	if (levels.empty())
+		return true;
+
+	float minX = 1, maxX = -1, minY = 1, maxY = -1, minZ = 1;
+	for (int i = 0; i < 8; i++) {
+		glm::vec4 corner(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z, 1);
+		glm::vec4 clip = viewProjection * corner;
+		if (clip.z + clip.w < 0 || clip.w <= 0)
+			return true;
+
+		float invW = 1.0f / clip.w;
+		float x = clip.x * invW;
+		float y = clip.y * invW;
+		float z = clip.z * invW;
+		minX = x < minX ? x : minX;
+		maxX = x > maxX ? x : maxX;
+		minY = y < minY ? y : minY;
+		maxY = y > maxY ? y : maxY;
+		minZ = z < minZ ? z : minZ;
+	}
+
+	// Outside the screen is decided by the frustum culling
+	if (maxX < -1 || maxY < -1 || minX > 1 || minY > 1)
+		return true;
+
+	float nearest = minZ * 0.5f + 0.5f;
+	float sx0 = (minX * 0.5f + 0.5f) * width;
+	float sx1 = (maxX * 0.5f + 0.5f) * width;
+	float sy0 = (minY * 0.5f + 0.5f) * height;
+	float sy1 = (maxY * 0.5f + 0.5f) * height;
+
+	unsigned int x0 = sx0 > 0 ? (unsigned int)sx0 : 0;
+	unsigned int y0 = sy0 > 0 ? (unsigned int)sy0 : 0;
+	x0 = x0 < width ? x0 : width - 1;
+	y0 = y0 < height ? y0 : height - 1;
+	unsigned int x1 = sx1 < width - 1 ? (unsigned int)sx1 : width - 1;
+	unsigned int y1 = sy1 < height - 1 ? (unsigned int)sy1 : height - 1;
+
+	// Coarsest level where the box covers at most 4x4 texels
+	unsigned int level = 0;
+	while (level + 1 < levels.size() && (x1 - x0 > 3 || y1 - y0 > 3)) {
+		x0 >>= 1; x1 >>= 1;
+		y0 >>= 1; y1 >>= 1;
+		level++;
+	}
+
+	const Level &L = levels[level];
+	for (unsigned int y = y0; y <= y1; y++) {
+		for (unsigned int x = x0; x <= x1; x++) {
+			if (L.depth[y * L.width + x] >= nearest)
+				return true;
+		}
+	}
+	return false;
+}
+
+unsigned int OcclusionCuller::GetWidth() const
+{
+	return width;
+}
+
+unsigned int OcclusionCuller::GetHeight() const
+{
+	return height;
+}
+
+unsigned int OcclusionCuller::GetLevels() const
+{
+	return (unsigned int)levels.size();
+}
+
+const float* OcclusionCuller::GetDepth(unsigned int level) const
+{
+	return levels[level].depth.data();
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <vector>
+
+#include <include/dll_export.h>
+#include <include/glm.h>
+
+using namespace std;
+
+/*
+ *	Software occlusion culling
+ *	Occluder triangles are rasterized into a small CPU depth buffer (4 pixels at a
+ *	time with SSE) and a max-depth hierarchy is built over it - a box is occluded when
+ *	its nearest depth is behind the farthest occluder depth of every texel it covers
+ *	Depth is the [0, 1] window depth, cleared to the far plane
+ */
+class DLLExport OcclusionCuller
+{
+	public:
+		OcclusionCuller();
+		~OcclusionCuller();
+
+		// Width is rounded up to a multiple of 4
+		void Init(unsigned int width, unsigned int height);
+
+		// Clear the depth buffer for a new view
+		void Begin(const glm::mat4 &viewProjection);
+
+		// Triangle list in model space (see Mesh::GetTriangles)
+		void RenderOccluder(const glm::mat4 &model, const vector<glm::vec3> &triangles);
+
+		// Must be called after the occluders and before the tests
+		void BuildHierarchy();
+
+		// Boxes crossing the near plane or leaving the screen are reported visible
+		bool IsVisible(const glm::vec3 &min, const glm::vec3 &max) const;
+
+		unsigned int GetWidth() const;
+		unsigned int GetHeight() const;
+		unsigned int GetLevels() const;
+		const float* GetDepth(unsigned int level = 0) const;
+
+	private:
+		void RasterizeTriangle(const glm::vec4 &v0, const glm::vec4 &v1, const glm::vec4 &v2);
+		void RasterizeClipped(const glm::vec4 &v0, const glm::vec4 &v1, const glm::vec4 &v2);
+
+	private:
+		struct Level {
+			unsigned int width;
+			unsigned int height;
+			vector<float> depth;
+		};
+
+		glm::mat4 viewProjection;
+		unsigned int width;
+		unsigned int height;
+
+		// Level 0 is the depth buffer
+		vector<Level> levels;
+};
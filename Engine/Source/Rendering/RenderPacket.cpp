@@ -0,0 +1,219 @@
+//#include <pch.h>
+#include "RenderPacket.h"
+
+#include <Component/AABB.h>
+#include <Component/ComponentStore.h>
+#include <Component/Mesh.h>
+#include <Component/SkinnedMesh.h>
+#include <Component/Transform.h>
+
+#include <Core/Camera/Camera.h>
+#include <Core/GameObject.h>
+
+#include <GPU/RingBuffer.h>
+#include <GPU/Shader.h>
+
+#include <Lighting/PointLight.h>
+
+#include <Manager/Manager.h>
+#include <Manager/RenderingSystem.h>
+
+// Levels added to the camera level in the shadow passes
+static const unsigned int SHADOW_LOD_BIAS = 1;
+
+RenderView::RenderView()
+{
+	position = glm::vec3(0);
+	zNear = 0;
+	zFar = 0;
+}
+
+void RenderView::Set(const Camera *camera)
+{
+	View = camera->View;
+	Projection = camera->Projection;
+	position = camera->transform->position;
+	zNear = camera->zNear;
+	zFar = camera->zFar;
+}
+
+void RenderView::BindPosition(GLint location) const
+{
+	glUniform3f(location, position.x, position.y, position.z);
+}
+
+void RenderView::BindViewMatrix(GLint location) const
+{
+	glUniformMatrix4fv(location, 1, false, glm::value_ptr(View));
+}
+
+void RenderView::BindProjectionMatrix(GLint location) const
+{
+	glUniformMatrix4fv(location, 1, false, glm::value_ptr(Projection));
+}
+
+void RenderView::BindProjectionDistances(const Shader *shader) const
+{
+	glUniform1f(shader->loc_z_far, zFar);
+	glUniform1f(shader->loc_z_near, zNear);
+}
+
+// Block used when the ring is out of space - updated in place, so the driver keeps the
+// draws of the previous views on their own data
+static GLuint fallbackFrameData = 0;
+
+// Shaders read the block from the ring - without space left the view goes through
+// the fallback buffer for this frame and the ring grows for the next ones
+void RenderView::BindFrameData() const
+{
+	FrameData data;
+	data.View = View;
+	data.Projection = Projection;
+	data.eyePosition = glm::vec4(position, 1);
+	data.zPlanes = glm::vec4(zNear, zFar, 0, 0);
+
+	RingBuffer *ring = Manager::GetRenderSys()->GetFrameData();
+	unsigned int offset = ring->Write(&data, sizeof(FrameData), ring->GetUniformAlignment());
+	if (offset != RingBuffer::INVALID_OFFSET) {
+		ring->BindRange(GL_UNIFORM_BUFFER, FRAME_DATA_BINDING, offset, sizeof(FrameData));
+		return;
+	}
+
+	if (!fallbackFrameData) {
+		glGenBuffers(1, &fallbackFrameData);
+		glBindBuffer(GL_UNIFORM_BUFFER, fallbackFrameData);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), nullptr, GL_DYNAMIC_DRAW);
+	}
+	glBindBuffer(GL_UNIFORM_BUFFER, fallbackFrameData);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &data);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_DATA_BINDING, fallbackFrameData);
+}
+
+RenderPacket::RenderPacket()
+{
+	frameID = 0;
+	elapsedTime = 0;
+	deltaTime = 0;
+	boneBase = 0;
+	bonesUploaded = false;
+}
+
+RenderPacket::~RenderPacket()
+{
+}
+
+// Keep the capacity - packets are reused every frame
+void RenderPacket::Clear()
+{
+	items.clear();
+	bones.clear();
+	boneBase = 0;
+	bonesUploaded = false;
+	lights.clear();
+	splitDistances.clear();
+	cascadeViews.clear();
+	cascadeProjections.clear();
+	shadowViews.clear();
+}
+
+void RenderPacket::AddObject(GameObject *obj, unsigned int flags)
+{
+	RenderItem item;
+	item.mesh = obj->mesh;
+	item.model = obj->transform->model;
+	item.flags = flags;
+	item.boneOffset = 0;
+	item.nrBones = 0;
+	item.cascadeMask = 0;
+	item.lod = obj->UpdateLOD(camera.position, camera.Projection[1][1]);
+	item.shadowLod = item.lod;
+	if (obj->mesh) {
+		unsigned int coarsest = obj->mesh->GetLODCount() - 1;
+		item.shadowLod = item.lod + SHADOW_LOD_BIAS < coarsest ? item.lod + SHADOW_LOD_BIAS : coarsest;
+	}
+
+	if (obj->mesh && obj->mesh->meshType == MeshType::SKINNED) {
+		auto skinned = static_cast<SkinnedMesh*>(obj->mesh);
+		auto &palette = skinned->GetBoneTransforms();
+		item.flags |= RENDER_SKINNED;
+		item.boneOffset = (unsigned int)bones.size();
+		item.nrBones = skinned->GetNumberOfBones();
+		bones.insert(bones.end(), palette.begin(), palette.begin() + item.nrBones);
+	}
+
+	// Cascade culling runs on the packet (see DirectionalLight::CullCasters)
+	if ((flags & RENDER_CAST_SHADOW) && obj->aabb) {
+		Manager::GetComponents()->GetWorldBounds(obj->aabb->transform->entity, item.boundsMin, item.boundsMax);
+		item.flags |= RENDER_BOUNDS;
+	}
+
+	items.push_back(item);
+}
+
+void RenderPacket::AddLight(PointLight *light)
+{
+	RenderLight data;
+	data.volume = light->light->mesh;
+	data.position = light->transform->position;
+	data.color = light->diffuseColor;
+	data.radius = light->effectRadius;
+	lights.push_back(data);
+}
+
+// Without ring space the palettes are stale for this frame - the ring grows for the next ones
+void RenderPacket::UploadBones()
+{
+	boneBase = 0;
+	bonesUploaded = bones.empty();
+	if (bones.empty())
+		return;
+
+	unsigned int size = (unsigned int)(bones.size() * sizeof(glm::mat4));
+	unsigned int offset = Manager::GetRenderSys()->GetFrameData()->Write(bones.data(), size, sizeof(glm::mat4));
+	if (offset == RingBuffer::INVALID_OFFSET)
+		return;
+
+	boneBase = offset / sizeof(glm::mat4);
+	bonesUploaded = true;
+}
+
+unsigned int RenderPacket::GetBoneOffset(const RenderItem &item) const
+{
+	return boneBase + item.boneOffset;
+}
+
+bool RenderPacket::CanRender(const RenderItem &item) const
+{
+	return bonesUploaded || !(item.flags & RENDER_SKINNED);
+}
+
+void RenderPacket::Render(const RenderItem &item, const Shader *shader, DrawState *state) const
+{
+	if (!item.mesh || !CanRender(item)) return;
+
+	glUniformMatrix4fv(shader->loc_model_matrix, 1, GL_FALSE, glm::value_ptr(item.model));
+
+	// Skip SkinnedMesh::Render - the palette was captured with the packet
+	if (item.flags & RENDER_SKINNED) {
+		glUniform1i(shader->loc_bone_offset, GetBoneOffset(item));
+		item.mesh->RenderLOD(shader, 0, state);
+		return;
+	}
+
+	if (item.lod || state)
+		item.mesh->RenderLOD(shader, item.lod, state);
+	else
+		item.mesh->Render(shader);
+}
+
+void RenderPacket::RenderShadow(const RenderItem &item, const Shader *shader, DrawState *state) const
+{
+	if (!item.mesh || (item.flags & RENDER_SKINNED) || !item.shadowLod) {
+		Render(item, shader, state);
+		return;
+	}
+
+	glUniformMatrix4fv(shader->loc_model_matrix, 1, GL_FALSE, glm::value_ptr(item.model));
+	item.mesh->RenderLOD(shader, item.shadowLod, state);
+}
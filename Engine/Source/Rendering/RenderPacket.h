@@ -0,0 +1,137 @@
+#pragma once
+#include <vector>
+
+#include <include/dll_export.h>
+#include <include/gl.h>
+#include <include/glm.h>
+
+class Camera;
+class GameObject;
+class Mesh;
+class PointLight;
+class Shader;
+struct DrawState;
+
+using namespace std;
+
+enum RenderItemFlags {
+	RENDER_VISIBLE		= 1 << 0,
+	RENDER_CAST_SHADOW	= 1 << 1,
+	RENDER_SKINNED		= 1 << 2,
+	RENDER_IN_VIEW		= 1 << 3,	// inside the culling camera frustum - RENDER_VISIBLE also keeps shadow casters
+	RENDER_BOUNDS		= 1 << 4	// boundsMin / boundsMax hold the world box
+};
+
+/*
+ *	Snapshot of the camera state needed for submission
+ */
+struct DLLExport RenderView
+{
+	RenderView();
+
+	void Set(const Camera *camera);
+	void BindPosition(GLint location) const;
+	void BindViewMatrix(GLint location) const;
+	void BindProjectionMatrix(GLint location) const;
+	void BindProjectionDistances(const Shader *shader) const;
+
+	// Writes the view to the frame ring and binds it to the FrameData block
+	void BindFrameData() const;
+
+	glm::mat4 View;
+	glm::mat4 Projection;
+	glm::vec3 position;
+	float zNear;
+	float zFar;
+};
+
+// std140 layout of the FrameData uniform block
+struct FrameData
+{
+	glm::mat4 View;
+	glm::mat4 Projection;
+	glm::vec4 eyePosition;
+	glm::vec4 zPlanes;		// near, far
+};
+
+struct RenderItem
+{
+	Mesh *mesh;
+	glm::mat4 model;
+	glm::vec3 boundsMin;		// shadow casters only - see RENDER_BOUNDS
+	glm::vec3 boundsMax;
+	unsigned int flags;
+	unsigned int boneOffset;
+	unsigned int nrBones;
+	unsigned int cascadeMask;	// bit i - the item casts into shadow cascade i
+	unsigned int lod;
+	unsigned int shadowLod;		// coarser than lod - shadow maps hide the detail
+};
+
+struct RenderLight
+{
+	Mesh *volume;
+	glm::vec3 position;
+	glm::vec3 color;
+	float radius;
+};
+
+/*
+ *	Immutable per-frame render data
+ *	Produced by World::Extract at the end of the simulation and consumed
+ *	by World::Render - possibly one frame later on a different thread
+ *	Nothing in here may point to state the simulation mutates: objects and lights
+ *	are copied by value and the only pointers are meshes, which are resources -
+ *	streamed ones are evicted once the packets drawing them were rendered
+ *	(see WorldPartition and Engine::GetRenderedFrameID)
+ */
+class DLLExport RenderPacket
+{
+	public:
+		RenderPacket();
+		~RenderPacket();
+
+		void Clear();
+		void AddObject(GameObject *obj, unsigned int flags);
+		void AddLight(PointLight *light);
+
+		// Write the bone palettes of all the skinned items to the frame ring - once,
+		// before the packet is rendered
+		void UploadBones();
+
+		// Matrix index of the item palette in the frame ring
+		unsigned int GetBoneOffset(const RenderItem &item) const;
+
+		// False for skinned items when the palettes did not fit in the ring this frame -
+		// they are skipped until the ring has grown
+		bool CanRender(const RenderItem &item) const;
+
+		// Draw an item (model matrix and bone palette come from the packet)
+		// Mesh levels are chosen from the packet camera - camera must be set before adding objects
+		// With a state, binds already done by the previous draw are skipped (see RenderQueue)
+		void Render(const RenderItem &item, const Shader *shader, DrawState *state = nullptr) const;
+		void RenderShadow(const RenderItem &item, const Shader *shader, DrawState *state = nullptr) const;
+
+	public:
+		unsigned int frameID;
+		float elapsedTime;
+		float deltaTime;
+
+		// main camera and the camera used for culling and shadow cascades
+		RenderView camera;
+		RenderView cullCamera;
+
+		// directional light cascades
+		vector<float> splitDistances;
+		vector<glm::mat4> cascadeViews;
+		vector<glm::mat4> cascadeProjections;
+
+		// spot light views
+		vector<RenderView> shadowViews;
+
+		vector<RenderItem> items;
+		vector<glm::mat4> bones;
+		unsigned int boneBase;
+		bool bonesUploaded;
+		vector<RenderLight> lights;
+};
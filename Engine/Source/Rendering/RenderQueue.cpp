@@ -0,0 +1,242 @@
+//#include <pch.h>
+#include "RenderQueue.h"
+
+#include <cstring>
+
+#include <Component/Mesh.h>
+
+#include <GPU/Material.h>
+#include <GPU/Shader.h>
+
+#include <Manager/Profiler.h>
+
+#include <Rendering/RenderPacket.h>
+
+static const unsigned int PASS_BITS		= 4;
+static const unsigned int SHADER_BITS	= 12;
+static const unsigned int MATERIAL_BITS	= 16;
+static const unsigned int MESH_BITS		= 16;
+static const unsigned int LOD_BITS		= 2;
+static const unsigned int DEPTH_BITS	= 14;
+
+static const unsigned int NO_INSTANCE	= 0xFFFFFFFF;
+
+DrawState::DrawState()
+{
+	Reset();
+}
+
+void DrawState::Reset()
+{
+	shader = nullptr;
+	VAO = 0;
+	texture = 0;
+	materialUBO = 0;
+	instanced = false;
+	draws = 0;
+	binds = 0;
+	bindsAvoided = 0;
+	instancedDraws = 0;
+	instances = 0;
+}
+
+RenderQueue::RenderQueue()
+{
+}
+
+RenderQueue::~RenderQueue()
+{
+}
+
+void RenderQueue::Clear()
+{
+	keys.clear();
+	draws.clear();
+}
+
+// Ids wrap around past maxID - objects sharing an id only sort less well
+unsigned int RenderQueue::GetID(unordered_map<const void*, unsigned int> &ids, const void *object, unsigned int maxID)
+{
+	auto id = ids.find(object);
+	if (id != ids.end())
+		return id->second;
+
+	unsigned int value = (unsigned int)ids.size() & maxID;
+	ids[object] = value;
+	return value;
+}
+
+void RenderQueue::Add(RenderPass pass, const Shader *shader, const RenderPacket &packet, unsigned int item, float depth)
+{
+	const RenderItem &data = packet.items[item];
+	if (!packet.CanRender(data))
+		return;
+
+	const Material *material = data.mesh ? data.mesh->GetFirstMaterial() : nullptr;
+	unsigned int lod = pass == RENDER_PASS_SHADOW ? data.shadowLod : data.lod;
+
+	unsigned long long key = (unsigned long long)(pass & ((1 << PASS_BITS) - 1));
+	key = (key << SHADER_BITS) | GetID(shaderIDs, shader, (1 << SHADER_BITS) - 1);
+	key = (key << MATERIAL_BITS) | GetID(materialIDs, material, (1 << MATERIAL_BITS) - 1);
+	key = (key << MESH_BITS) | GetID(meshIDs, data.mesh, (1 << MESH_BITS) - 1);
+	key = (key << LOD_BITS) | (lod & ((1 << LOD_BITS) - 1));
+
+	depth = depth < 0 ? 0 : (depth > 1 ? 1 : depth);
+	key = (key << DEPTH_BITS) | (unsigned int)(depth * ((1 << DEPTH_BITS) - 1));
+
+	Draw draw;
+	draw.shader = shader;
+	draw.item = item;
+	draw.pass = pass;
+	draw.lod = lod;
+	draw.instances = 1;
+	draw.instanceOffset = NO_INSTANCE;
+	keys.push_back(key);
+	draws.push_back(draw);
+}
+
+// LSD radix sort of the keys and their draws - stable, so equal keys keep the packet order
+void RenderQueue::Sort()
+{
+	PROFILE_SCOPE("Sort Render Queue");
+	unsigned int size = (unsigned int)keys.size();
+	sortedKeys.resize(size);
+	sortedDraws.resize(size);
+
+	unsigned int counts[256];
+	for (unsigned int shift = 0; shift < 64; shift += 8) {
+		memset(counts, 0, sizeof(counts));
+		for (auto key : keys)
+			counts[(key >> shift) & 0xFF]++;
+
+		// every key has the same digit
+		if (size == 0 || counts[(keys[0] >> shift) & 0xFF] == size)
+			continue;
+
+		unsigned int offset = 0;
+		for (unsigned int i = 0; i < 256; i++) {
+			unsigned int count = counts[i];
+			counts[i] = offset;
+			offset += count;
+		}
+
+		for (unsigned int i = 0; i < size; i++) {
+			unsigned int index = counts[(keys[i] >> shift) & 0xFF]++;
+			sortedKeys[index] = keys[i];
+			sortedDraws[index] = draws[i];
+		}
+		keys.swap(sortedKeys);
+		draws.swap(sortedDraws);
+	}
+}
+
+// Sorted draws of one mesh are next to each other - the models of every run are
+// written to the instance buffer and the run is marked on its first draw
+bool RenderQueue::BuildInstances(const RenderPacket &packet)
+{
+	instanceBuffer.Clear();
+
+	unsigned int size = (unsigned int)draws.size();
+	unsigned int start = 0;
+	while (start < size) {
+		Draw &first = draws[start];
+		const RenderItem &item = packet.items[first.item];
+
+		unsigned int end = start + 1;
+		bool instanced = item.mesh && first.shader->loc_instanced >= 0;
+		if (instanced) {
+			while (end < size) {
+				const Draw &draw = draws[end];
+				const RenderItem &next = packet.items[draw.item];
+				if (draw.shader != first.shader || draw.pass != first.pass || draw.lod != first.lod || next.mesh != item.mesh)
+					break;
+				end++;
+			}
+		}
+
+		// A full buffer leaves the remaining draws to the model uniform
+		if (instanced && instanceBuffer.GetSize() + (end - start) > InstanceBuffer::MAX_INSTANCES) {
+			instanced = false;
+			end = start + 1;
+		}
+
+		first.instances = end - start;
+		first.instanceOffset = instanced ? instanceBuffer.GetSize() : NO_INSTANCE;
+		if (instanced) {
+			for (unsigned int i = start; i < end; i++) {
+				const RenderItem &instance = packet.items[draws[i].item];
+				float boneOffset = (instance.flags & RENDER_SKINNED) ? (float)packet.GetBoneOffset(instance) : 0;
+				instanceBuffer.Add(instance.model, glm::vec4(boneOffset, 0, 0, 0));
+			}
+		}
+		start = end;
+	}
+
+	return instanceBuffer.Upload();
+}
+
+void RenderQueue::Submit(const RenderPacket &packet)
+{
+	state.Reset();
+
+	// Out of ring space - every draw sets its model
+	bool uploaded = BuildInstances(packet);
+	unsigned int baseInstance = instanceBuffer.GetBaseInstance();
+
+	unsigned int size = (unsigned int)draws.size();
+	for (unsigned int i = 0; i < size; i += uploaded ? draws[i].instances : 1) {
+		const Draw &draw = draws[i];
+		const RenderItem &item = packet.items[draw.item];
+
+		if (state.shader != draw.shader) {
+			if (state.instanced)
+				glUniform1i(state.shader->loc_instanced, 0);
+			draw.shader->Use();
+			state.shader = draw.shader;
+			state.instanced = false;
+			state.binds++;
+		}
+		else {
+			state.bindsAvoided++;
+		}
+
+		bool instanced = uploaded && draw.instanceOffset != NO_INSTANCE;
+		if (instanced != state.instanced) {
+			glUniform1i(draw.shader->loc_instanced, instanced ? 1 : 0);
+			state.instanced = instanced;
+		}
+
+		if (instanced) {
+			glUniform1i(draw.shader->loc_instance_offset, baseInstance + draw.instanceOffset);
+			item.mesh->RenderLOD(draw.shader, draw.lod, &state, draw.instances);
+			if (draw.instances > 1) {
+				state.instancedDraws++;
+				state.instances += draw.instances;
+			}
+		}
+		else if (draw.pass == RENDER_PASS_SHADOW) {
+			packet.RenderShadow(item, draw.shader, &state);
+		}
+		else {
+			packet.Render(item, draw.shader, &state);
+		}
+		state.draws++;
+	}
+
+	// Passes outside of the queue use the model uniform
+	if (state.instanced)
+		glUniform1i(state.shader->loc_instanced, 0);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+unsigned int RenderQueue::GetSize() const
+{
+	return (unsigned int)keys.size();
+}
+
+const DrawState& RenderQueue::GetState() const
+{
+	return state;
+}
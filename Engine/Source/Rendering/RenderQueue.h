@@ -0,0 +1,99 @@
+#pragma once
+#include <unordered_map>
+#include <vector>
+
+#include <include/dll_export.h>
+#include <include/gl.h>
+
+#include <Rendering/InstanceBuffer.h>
+
+class Shader;
+class RenderPacket;
+struct RenderItem;
+
+using namespace std;
+
+enum RenderPass {
+	RENDER_PASS_GBUFFER,
+	RENDER_PASS_SHADOW,
+	RENDER_PASS_FORWARD
+};
+
+/*
+ *	GL objects bound by the last draw of a queue submission
+ *	Binds of an object that is already bound are skipped and counted
+ */
+struct DLLExport DrawState
+{
+	DrawState();
+	void Reset();
+
+	const Shader *shader;
+	GLuint VAO;
+	GLuint texture;
+	GLuint materialUBO;
+	bool instanced;				// instanced uniform of the current shader
+
+	unsigned int draws;
+	unsigned int binds;
+	unsigned int bindsAvoided;
+	unsigned int instancedDraws;
+	unsigned int instances;
+};
+
+/*
+ *	Draws of a frame ordered by a packed 64-bit key
+ *	| pass 4 | shader 12 | material 16 | mesh 16 | lod 2 | depth 14 |
+ *	so draws sharing a program, texture and vertex array end up next to each other,
+ *	front to back inside a group
+ *	Keys are radix sorted 8 bits at a time - digits equal in every key are skipped
+ *	When the shader reads the instance buffer the models are written once to the frame
+ *	ring and draws only pass their offset - runs of the same shader, mesh and level of
+ *	detail are submitted as one instanced draw. Skinned instances also carry the
+ *	offset of their bone palette
+ */
+class DLLExport RenderQueue
+{
+	public:
+		RenderQueue();
+		~RenderQueue();
+
+		void Clear();
+
+		// depth is the distance to the camera over zFar - items are indices into the packet
+		void Add(RenderPass pass, const Shader *shader, const RenderPacket &packet, unsigned int item, float depth);
+		void Sort();
+		void Submit(const RenderPacket &packet);
+
+		unsigned int GetSize() const;
+
+		// Counters of the last submission
+		const DrawState& GetState() const;
+
+	private:
+		unsigned int GetID(unordered_map<const void*, unsigned int> &ids, const void *object, unsigned int maxID);
+		bool BuildInstances(const RenderPacket &packet);
+
+	private:
+		struct Draw {
+			const Shader *shader;
+			unsigned int item;
+			RenderPass pass;
+			unsigned int lod;
+			unsigned int instances;			// draws of the run starting here
+			unsigned int instanceOffset;	// NO_INSTANCE outside of the instance buffer
+		};
+
+		vector<unsigned long long> keys;
+		vector<unsigned long long> sortedKeys;
+		vector<Draw> draws;
+		vector<Draw> sortedDraws;
+
+		// Stable ids of the sorted objects - kept between frames
+		unordered_map<const void*, unsigned int> shaderIDs;
+		unordered_map<const void*, unsigned int> materialIDs;
+		unordered_map<const void*, unsigned int> meshIDs;
+
+		DrawState state;
+		InstanceBuffer instanceBuffer;
+};
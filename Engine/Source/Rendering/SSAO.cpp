@@ -3,7 +3,6 @@
 
 #include <include/math.h>
 
-#include <Core/Camera/Camera.h>
 #include <GPU/Texture.h>
 #include <GPU/Shader.h>
 
@@ -12,6 +11,8 @@
 #include <Manager/ShaderManager.h>
 #include <Manager/ResourceManager.h>
 
+#include <Rendering/RenderPacket.h>
+
 
 SSAO::SSAO()
 {
@@ -48,7 +49,7 @@ void SSAO::Init(int width, int height)
 	computeTexture->Create2DTextureFloat(NULL, width, height, 4);
 }
 
-void SSAO::Update(const FrameBuffer *FBO, const Camera *camera) const
+void SSAO::Update(const FrameBuffer *FBO, const RenderView &camera) const
 {
 	ssaoFBO.Bind();
 	glDepthMask(GL_FALSE);
@@ -59,9 +60,9 @@ void SSAO::Update(const FrameBuffer *FBO, const Camera *camera) const
 	ssao->BindTexturesUnits();
 
 	ssaoFBO.SendResolution(ssao);
-	camera->BindViewMatrix(ssao->loc_view_matrix);
-	camera->BindProjectionMatrix(ssao->loc_projection_matrix);
-	camera->BindProjectionDistances(ssao);
+	camera.BindViewMatrix(ssao->loc_view_matrix);
+	camera.BindProjectionMatrix(ssao->loc_projection_matrix);
+	camera.BindProjectionDistances(ssao);
 
 	glUniform1f(ssao->loc_u_rad, radius);
 	glUniform1i(ssao->loc_kernel_size, kernelSize);
@@ -8,6 +8,7 @@
  */
 
 class Camera;
+struct RenderView;
 
 class DLLExport SSAO {
 	public:
@@ -15,7 +16,7 @@ class DLLExport SSAO {
 		~SSAO();
 
 		void Init(int width, int height);
-		void Update(const FrameBuffer *FBO, const Camera *camera) const;
+		void Update(const FrameBuffer *FBO, const RenderView &camera) const;
 		void BindTexture(GLenum TextureUnit);
 
 	private:
@@ -1,5 +1,7 @@
 #include "ColorPicking.h"
 
+#include <algorithm>
+
 #include <Core/GameObject.h>
 
 #include <Component/AABB.h>
@@ -98,10 +100,20 @@ void ColorPicking::Update(const Camera* activeCamera){
 	camera->BindViewMatrix(cpShader->loc_view_matrix);
 	camera->BindProjectionMatrix(cpShader->loc_projection_matrix);
 
-	for (auto *obj : Manager::GetScene()->activeObjects) {
-		glUniform4f(cpShader->loc_debug_color, obj->colorID.r, obj->colorID.g, obj->colorID.b, 0);
-		obj->Render(cpShader);
-	}
+	// only the objects whose bounds are hit by the ray under the cursor can be picked
+	glm::ivec2 resolution = Engine::Window->resolution;
+	glm::vec2 ndc(2.0f * mousePosition.x / resolution.x - 1.0f, 1.0f - 2.0f * mousePosition.y / resolution.y);
+	glm::mat4 invViewProjection = glm::inverse(camera->Projection * camera->View);
+	glm::vec4 rayNear = invViewProjection * glm::vec4(ndc, -1.0f, 1.0f);
+	glm::vec4 rayFar = invViewProjection * glm::vec4(ndc, 1.0f, 1.0f);
+	glm::vec3 rayOrigin = glm::vec3(rayNear) / rayNear.w;
+	glm::vec3 rayDirection = glm::vec3(rayFar) / rayFar.w - rayOrigin;
+	float rayLength = glm::length(rayDirection);
+
+	vector<GameObject*> candidates;
+	Manager::GetScene()->QueryRay(rayOrigin, rayDirection / rayLength, rayLength, candidates);
+
+	RenderCandidates(candidates);
 
 	//draw gizmo objects for color picking
 	glDisable(GL_DEPTH_TEST);
@@ -117,6 +129,7 @@ void ColorPicking::Update(const Camera* activeCamera){
 		}
 		else
 			crt_gizmo_obj->transform->SetRotation(90.0f * gizmo[i].axis);
+		crt_gizmo_obj->transform->Update();
 
 		glUniform4f(cpShader->loc_debug_color, crt_gizmo_obj->colorID.r, crt_gizmo_obj->colorID.g, crt_gizmo_obj->colorID.b, 0);
 		crt_gizmo_obj->Render(cpShader);
@@ -139,7 +152,7 @@ void ColorPicking::Update(const Camera* activeCamera){
 	if (!gizmoEvent){
 		selectedObject = NULL;
 		//check for objects click
-		for (auto *obj : Manager::GetScene()->activeObjects) {
+		for (auto *obj : candidates) {
 			if (obj->colorID == pickedColor) {
 				selectedObject = obj;
 				break;
@@ -151,6 +164,55 @@ void ColorPicking::Update(const Camera* activeCamera){
 
 }
 
+// candidates sharing a static mesh are drawn instanced, the color id goes with the model
+void ColorPicking::RenderCandidates(vector<GameObject*> &candidates) {
+
+	stable_sort(candidates.begin(), candidates.end(), [](const GameObject *a, const GameObject *b) {
+		return a->mesh < b->mesh;
+	});
+
+	instances.Clear();
+	vector<unsigned int> runs;
+	unsigned int size = (unsigned int)candidates.size();
+	for (unsigned int start = 0; start < size;) {
+		unsigned int end = start + 1;
+		Mesh *mesh = candidates[start]->mesh;
+		if (mesh && mesh->meshType != MeshType::SKINNED && cpShader->loc_instanced >= 0) {
+			while (end < size && candidates[end]->mesh == mesh && end - start < InstanceBuffer::MAX_INSTANCES)
+				end++;
+		}
+		runs.push_back(end - start);
+		if (end - start > 1) {
+			for (unsigned int i = start; i < end; i++)
+				instances.Add(candidates[i]->transform->model, glm::vec4(candidates[i]->colorID, 0));
+		}
+		start = end;
+	}
+
+	// without ring space every candidate is drawn on its own
+	bool uploaded = instances.GetSize() && instances.Upload();
+
+	unsigned int start = 0;
+	unsigned int offset = instances.GetBaseInstance();
+	for (auto count : runs) {
+		if (count > 1 && uploaded) {
+			glUniform1i(cpShader->loc_instanced, 1);
+			glUniform1i(cpShader->loc_instance_offset, offset);
+			candidates[start]->mesh->RenderLOD(cpShader, 0, nullptr, count);
+			glUniform1i(cpShader->loc_instanced, 0);
+			offset += count;
+		}
+		else {
+			for (unsigned int i = start; i < start + count; i++) {
+				GameObject *obj = candidates[i];
+				glUniform4f(cpShader->loc_debug_color, obj->colorID.r, obj->colorID.g, obj->colorID.b, 0);
+				obj->Render(cpShader);
+			}
+		}
+		start += count;
+	}
+}
+
 void ColorPicking::OnMouseBtnEvent(int mouseX, int mouseY, int button, int action, int mods) {
 	//on left click press
 	if (button == 0 && action == 1) {
@@ -194,6 +256,9 @@ void ColorPicking::OnMouseMove(int mouseX, int mouseY, int deltaX, int deltaY) {
 				glm::vec3(deltaX - deltaY) / glm::vec3(200.0f)
 			);
 		}
+
+		// static objects are not refit by the scene every frame
+		Manager::GetScene()->RefitObject(selectedObject);
 	}
 }
 
@@ -246,6 +311,8 @@ void ColorPicking::DrawGizmo() {
 			}
 			else
 				crt_gizmo_obj->transform->SetRotation(90.0f * gizmo[i].axis);
+			crt_gizmo_obj->transform->Update();
+
 			if (currentAxis == gizmo[i].color)
 				glUniform4f(gizmoShader->loc_debug_color, 1, 1, 0, 1.0f);
 			else
@@ -3,6 +3,7 @@
 #include <include/dll_export.h>
 
 #include <Component/ObjectInput.h>
+#include <Rendering/InstanceBuffer.h>
 
 
 class Camera;
@@ -37,7 +38,10 @@ public:
 	GameObject	*selectedObject;
 
 private:
+	void RenderCandidates(vector<GameObject*> &candidates);
+
 	Shader *cpShader;
+	InstanceBuffer instances;
 	Shader *gizmoShader;
 
 	glm::ivec2 mousePosition;
@@ -1,6 +1,53 @@
 //#include <pch.h>
 #include "3D.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+// Symmetric 4x4 matrix of the squared plane distances - a2 ab ac ad b2 bc bd c2 cd d2
+struct Quadric {
+	double q[10];
+};
+
+static void AddPlane(Quadric &Q, double a, double b, double c, double d, double weight)
+{
+	Q.q[0] += weight * a * a;	Q.q[1] += weight * a * b;	Q.q[2] += weight * a * c;	Q.q[3] += weight * a * d;
+	Q.q[4] += weight * b * b;	Q.q[5] += weight * b * c;	Q.q[6] += weight * b * d;
+	Q.q[7] += weight * c * c;	Q.q[8] += weight * c * d;
+	Q.q[9] += weight * d * d;
+}
+
+static double Evaluate(const Quadric &Q, const Quadric &R, const glm::vec3 &p)
+{
+	double q[10];
+	for (int i = 0; i < 10; i++)
+		q[i] = Q.q[i] + R.q[i];
+
+	double x = p.x, y = p.y, z = p.z;
+	double error = q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z + 2 * q[3] * x
+				 + q[4] * y * y + 2 * q[5] * y * z + 2 * q[6] * y
+				 + q[7] * z * z + 2 * q[8] * z
+				 + q[9];
+	return error > 0 ? error : 0;
+}
+
+static unsigned long long EdgeKey(unsigned int a, unsigned int b)
+{
+	return a < b ? ((unsigned long long)a << 32) | b : ((unsigned long long)b << 32) | a;
+}
+
+struct Collapse {
+	unsigned int from;
+	unsigned int to;
+	double cost;
+
+	bool operator<(const Collapse &other) const {
+		return cost < other.cost;
+	}
+};
+
 namespace Utils3D {
 
 	void PushQuad2Triangle(vector<unsigned short> &indices,
@@ -22,5 +69,186 @@ namespace Utils3D {
 			indices.push_back(v2);
 			indices.push_back(v3);
 	}
+
+	DLLExport void ExtractFrustumPlanes(const glm::mat4 &viewProjection, glm::vec4 planes[6]) {
+		// rows of the matrix - glm is column major
+		glm::vec4 row[4];
+		for (int i = 0; i < 4; i++)
+			row[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+
+		planes[0] = row[3] + row[0];
+		planes[1] = row[3] - row[0];
+		planes[2] = row[3] + row[1];
+		planes[3] = row[3] - row[1];
+		planes[4] = row[3] + row[2];
+		planes[5] = row[3] - row[2];
+
+		for (int i = 0; i < 6; i++)
+			planes[i] /= glm::length(glm::vec3(planes[i]));
+	}
+
+	/*
+	 *	Each pass sorts the candidate collapses of all edges by error and applies the
+	 *	cheapest ones that do not touch a vertex already changed in the pass and do not
+	 *	flip a triangle - passes repeat until the target is reached or nothing collapses
+	 */
+	DLLExport float SimplifyMesh(const glm::vec3 *positions, unsigned int nrVertices,
+								 const unsigned short *indices, unsigned int nrIndices,
+								 unsigned int targetIndices, vector<unsigned short> &result)
+	{
+		const double BORDER_WEIGHT = 10;
+
+		result.assign(indices, indices + nrIndices - nrIndices % 3);
+		if (result.size() <= targetIndices)
+			return 0;
+
+		// Plane quadrics weighted by the triangle area
+		vector<Quadric> quadrics(nrVertices);
+		memset(quadrics.data(), 0, sizeof(Quadric) * nrVertices);
+
+		unordered_map<unsigned long long, unsigned int> edgeUse;
+		for (size_t t = 0; t < result.size(); t += 3) {
+			for (int k = 0; k < 3; k++)
+				edgeUse[EdgeKey(result[t + k], result[t + (k + 1) % 3])]++;
+		}
+
+		for (size_t t = 0; t < result.size(); t += 3) {
+			const glm::vec3 &p0 = positions[result[t]];
+			glm::vec3 normal = glm::cross(positions[result[t + 1]] - p0, positions[result[t + 2]] - p0);
+			float area = glm::length(normal);
+			if (area == 0)
+				continue;
+			normal /= area;
+
+			for (int k = 0; k < 3; k++)
+				AddPlane(quadrics[result[t + k]], normal.x, normal.y, normal.z, -glm::dot(normal, p0), area);
+
+			// Open edges get a plane through the edge, perpendicular to the triangle
+			for (int k = 0; k < 3; k++) {
+				unsigned int a = result[t + k];
+				unsigned int b = result[t + (k + 1) % 3];
+				if (edgeUse[EdgeKey(a, b)] != 1)
+					continue;
+				glm::vec3 edge = positions[b] - positions[a];
+				glm::vec3 side = glm::cross(edge, normal);
+				float length = glm::length(side);
+				if (length == 0)
+					continue;
+				side /= length;
+				double d = -glm::dot(side, positions[a]);
+				double weight = BORDER_WEIGHT * glm::dot(edge, edge);
+				AddPlane(quadrics[a], side.x, side.y, side.z, d, weight);
+				AddPlane(quadrics[b], side.x, side.y, side.z, d, weight);
+			}
+		}
+
+		double maxError = 0;
+		vector<Collapse> collapses;
+		vector<unsigned int> remap(nrVertices);
+		vector<char> locked(nrVertices);
+		vector<unsigned int> firstTriangle(nrVertices + 1);
+		vector<unsigned int> vertexTriangles;
+
+		while (result.size() > targetIndices) {
+			unsigned int nrTriangles = (unsigned int)result.size() / 3;
+
+			collapses.clear();
+			for (unsigned int t = 0; t < nrTriangles; t++) {
+				for (int k = 0; k < 3; k++) {
+					unsigned int a = result[t * 3 + k];
+					unsigned int b = result[t * 3 + (k + 1) % 3];
+					Collapse c;
+					double toB = Evaluate(quadrics[a], quadrics[b], positions[b]);
+					double toA = Evaluate(quadrics[a], quadrics[b], positions[a]);
+					c.from = toB <= toA ? a : b;
+					c.to = toB <= toA ? b : a;
+					c.cost = toB <= toA ? toB : toA;
+					collapses.push_back(c);
+				}
+			}
+			sort(collapses.begin(), collapses.end());
+
+			// Triangles around each vertex
+			fill(firstTriangle.begin(), firstTriangle.end(), 0);
+			for (auto index : result)
+				firstTriangle[index + 1]++;
+			for (unsigned int v = 0; v < nrVertices; v++)
+				firstTriangle[v + 1] += firstTriangle[v];
+			vertexTriangles.resize(result.size());
+			{
+				vector<unsigned int> fillCount(firstTriangle.begin(), firstTriangle.end() - 1);
+				for (unsigned int i = 0; i < result.size(); i++)
+					vertexTriangles[fillCount[result[i]]++] = i / 3;
+			}
+
+			for (unsigned int v = 0; v < nrVertices; v++)
+				remap[v] = v;
+			fill(locked.begin(), locked.end(), 0);
+
+			unsigned int toRemove = ((unsigned int)result.size() - targetIndices) / 3;
+			unsigned int removed = 0;
+			for (auto &c : collapses) {
+				if (removed >= toRemove)
+					break;
+				if (locked[c.from] || locked[c.to])
+					continue;
+
+				// Moving c.from onto c.to must not flip the triangles left around it
+				bool flips = false;
+				unsigned int shared = 0;
+				for (unsigned int i = firstTriangle[c.from]; i < firstTriangle[c.from + 1] && !flips; i++) {
+					const unsigned short *tri = &result[vertexTriangles[i] * 3];
+					if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to) {
+						shared++;
+						continue;
+					}
+					glm::vec3 p[3], q[3];
+					for (int k = 0; k < 3; k++) {
+						p[k] = positions[tri[k]];
+						q[k] = tri[k] == c.from ? positions[c.to] : p[k];
+					}
+					glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+					glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+					flips = glm::dot(before, after) <= 0;
+				}
+				if (flips || shared == 0)
+					continue;
+
+				for (unsigned int i = firstTriangle[c.from]; i < firstTriangle[c.from + 1]; i++) {
+					const unsigned short *tri = &result[vertexTriangles[i] * 3];
+					locked[tri[0]] = locked[tri[1]] = locked[tri[2]] = 1;
+				}
+				for (unsigned int i = firstTriangle[c.to]; i < firstTriangle[c.to + 1]; i++) {
+					const unsigned short *tri = &result[vertexTriangles[i] * 3];
+					locked[tri[0]] = locked[tri[1]] = locked[tri[2]] = 1;
+				}
+
+				remap[c.from] = c.to;
+				for (int i = 0; i < 10; i++)
+					quadrics[c.to].q[i] += quadrics[c.from].q[i];
+				maxError = c.cost > maxError ? c.cost : maxError;
+				removed += shared;
+			}
+
+			if (removed == 0)
+				break;
+
+			// Remap and drop the collapsed triangles
+			unsigned int count = 0;
+			for (unsigned int t = 0; t < nrTriangles; t++) {
+				unsigned short a = (unsigned short)remap[result[t * 3]];
+				unsigned short b = (unsigned short)remap[result[t * 3 + 1]];
+				unsigned short c = (unsigned short)remap[result[t * 3 + 2]];
+				if (a == b || b == c || a == c)
+					continue;
+				result[count++] = a;
+				result[count++] = b;
+				result[count++] = c;
+			}
+			result.resize(count);
+		}
+
+		return (float)maxError;
+	}
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include <include/dll_export.h>
+#include <include/glm.h>
 
 using namespace std;
 
@@ -9,4 +10,16 @@ typedef unsigned int UINT32;
 namespace Utils3D {
 	DLLExport void PushQuad(vector<unsigned short> &indices,
 				  UINT32 v0, UINT32 v1, UINT32 v2, UINT32 v3);
+
+	// Frustum planes (left, right, bottom, top, near, far) of a View * Projection matrix
+	// Planes are normalized, with the normals pointing inside: dot(plane, (p, 1)) >= 0
+	DLLExport void ExtractFrustumPlanes(const glm::mat4 &viewProjection, glm::vec4 planes[6]);
+
+	// Quadric error edge collapse of a triangle list down to about targetIndices
+	// Vertices are only collapsed onto other vertices, so the result indexes the same
+	// vertex buffer - open edges (borders and UV seams) are kept in place
+	// Returns the largest collapse error (squared distance)
+	DLLExport float SimplifyMesh(const glm::vec3 *positions, unsigned int nrVertices,
+								 const unsigned short *indices, unsigned int nrIndices,
+								 unsigned int targetIndices, vector<unsigned short> &result);
 }
\ No newline at end of file
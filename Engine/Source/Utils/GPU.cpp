@@ -8,6 +8,9 @@ namespace UtilsGPU {
 					const vector<unsigned short>& indices)
 	{
 		GPUBuffers *buffers = new GPUBuffers(3);
+		if (Engine::IsHeadless())
+			return buffers;
+
 		glBindVertexArray(buffers->VAO);
 
 		// Generate and populate the buffers with vertex attributes and the indices
@@ -38,6 +41,9 @@ namespace UtilsGPU {
 	{
 		// Create the VAO
 		GPUBuffers *buffers = new GPUBuffers(3);
+		if (Engine::IsHeadless())
+			return buffers;
+
 		glBindVertexArray(buffers->VAO);
 
 		// Generate and populate the buffers with vertex attributes and the indices
@@ -69,6 +75,9 @@ namespace UtilsGPU {
 	{
 		// Create the VAO
 		GPUBuffers *buffers = new GPUBuffers(4);
+		if (Engine::IsHeadless())
+			return buffers;
+
 		glBindVertexArray(buffers->VAO);
 
 		// Generate and populate the buffers with vertex attributes and the indices
@@ -5,6 +5,8 @@
 #include <include/utils.h>
 #include <vector>
 
+#include <Core/Engine.h>
+
 using namespace std;
 
 namespace BUFFERTYPE {
@@ -37,13 +39,18 @@ class GPUBuffers
 		GPUBuffers(unsigned int size)
 			: size(size)
 		{
-			VBO = new GLuint[size];
+			VAO = 0;
+			VBO = new GLuint[size]();
+			if (Engine::IsHeadless())
+				return;
 			glGenVertexArrays(1, &VAO);
 			glGenBuffers(size, VBO);
 		}
 		~GPUBuffers() {
-			glDeleteVertexArrays(1, &VAO);
-			glDeleteBuffers(size, VBO);
+			if (!Engine::IsHeadless()) {
+				glDeleteVertexArrays(1, &VAO);
+				glDeleteBuffers(size, VBO);
+			}
 			SAFE_FREE(VBO);
 		}
 
@@ -77,6 +84,9 @@ namespace UtilsGPU {
 	{
 		// Create the VAO
 		GPUBuffers *buffers = new GPUBuffers(5);
+		if (Engine::IsHeadless())
+			return buffers;
+
 		glBindVertexArray(buffers->VAO);
 
 		// Generate and populate the buffers with vertex attributes and the indices
@@ -0,0 +1,163 @@
+#pragma once
+#include <vector>
+
+/*
+ *	Generational handle into a SlotMap
+ *	A handle stays valid until its element is removed - after that the slot
+ *	generation changes and lookups with the old handle fail
+ *	Generation 0 is never used by a live slot, so a zeroed handle is invalid
+ */
+struct SlotHandle {
+	unsigned int index;
+	unsigned int generation;
+
+	SlotHandle() : index(0), generation(0) {};
+	SlotHandle(unsigned int index, unsigned int generation) : index(index), generation(generation) {};
+
+	bool operator==(const SlotHandle &other) const { return index == other.index && generation == other.generation; };
+	bool operator!=(const SlotHandle &other) const { return !(*this == other); };
+};
+
+/*
+ *	Dense array of values addressed through generational handles
+ *	Insert and Remove are O(1) - a removed value only invalidates its handle and
+ *	stays in the dense array until Compact, which drops all of them in one pass
+ *	Iteration walks the dense array in insertion order - call Compact after a batch
+ *	of removals (e.g. at the frame boundary) and before iterating again
+ */
+template<class T>
+class SlotMap {
+	public:
+		typedef typename std::vector<T>::iterator iterator;
+		typedef typename std::vector<T>::const_iterator const_iterator;
+
+	public:
+		SlotMap() : nrRemoved(0) {};
+
+		SlotHandle Insert(const T &value);
+		bool Remove(SlotHandle handle);
+		void Compact();
+		void Clear();
+
+		bool IsValid(SlotHandle handle) const;
+		T* Get(SlotHandle handle);
+		const T* Get(SlotHandle handle) const;
+
+		unsigned int size() const { return (unsigned int)values.size(); };
+		bool empty() const { return values.empty(); };
+		T& operator[](unsigned int i) { return values[i]; };
+		const T& operator[](unsigned int i) const { return values[i]; };
+
+		iterator begin() { return values.begin(); };
+		iterator end() { return values.end(); };
+		const_iterator begin() const { return values.begin(); };
+		const_iterator end() const { return values.end(); };
+
+	private:
+		struct Slot {
+			unsigned int dense;
+			unsigned int generation;
+		};
+
+		// denseToSlot entry of a removed value waiting for Compact
+		static const unsigned int REMOVED = 0xFFFFFFFF;
+
+		void Release(unsigned int index);
+
+	private:
+		std::vector<T> values;
+		std::vector<unsigned int> denseToSlot;
+		std::vector<Slot> slots;
+		std::vector<unsigned int> freeSlots;
+		unsigned int nrRemoved;
+};
+
+template<class T>
+SlotHandle SlotMap<T>::Insert(const T &value) {
+	unsigned int index;
+	if (freeSlots.empty()) {
+		index = (unsigned int)slots.size();
+		Slot slot;
+		slot.generation = 1;
+		slots.push_back(slot);
+	}
+	else {
+		index = freeSlots.back();
+		freeSlots.pop_back();
+	}
+
+	slots[index].dense = (unsigned int)values.size();
+	values.push_back(value);
+	denseToSlot.push_back(index);
+	return SlotHandle(index, slots[index].generation);
+}
+
+template<class T>
+bool SlotMap<T>::Remove(SlotHandle handle) {
+	if (!IsValid(handle))
+		return false;
+
+	denseToSlot[slots[handle.index].dense] = REMOVED;
+	nrRemoved++;
+
+	Release(handle.index);
+	return true;
+}
+
+// Shift the remaining values over the removed ones - the order is kept
+template<class T>
+void SlotMap<T>::Compact() {
+	if (!nrRemoved)
+		return;
+
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < values.size(); i++) {
+		if (denseToSlot[i] == REMOVED)
+			continue;
+		if (count != i) {
+			values[count] = values[i];
+			denseToSlot[count] = denseToSlot[i];
+			slots[denseToSlot[count]].dense = count;
+		}
+		count++;
+	}
+
+	values.erase(values.begin() + count, values.end());
+	denseToSlot.resize(count);
+	nrRemoved = 0;
+}
+
+template<class T>
+void SlotMap<T>::Clear() {
+	for (auto index : denseToSlot) {
+		if (index != REMOVED)
+			Release(index);
+	}
+	values.clear();
+	denseToSlot.clear();
+	nrRemoved = 0;
+}
+
+template<class T>
+void SlotMap<T>::Release(unsigned int index) {
+	slots[index].generation++;
+	if (slots[index].generation == 0)
+		slots[index].generation = 1;
+	freeSlots.push_back(index);
+}
+
+template<class T>
+bool SlotMap<T>::IsValid(SlotHandle handle) const {
+	return handle.generation != 0 && handle.index < slots.size() &&
+		slots[handle.index].generation == handle.generation;
+}
+
+template<class T>
+T* SlotMap<T>::Get(SlotHandle handle) {
+	return IsValid(handle) ? &values[slots[handle.index].dense] : nullptr;
+}
+
+template<class T>
+const T* SlotMap<T>::Get(SlotHandle handle) const {
+	return IsValid(handle) ? &values[slots[handle.index].dense] : nullptr;
+}
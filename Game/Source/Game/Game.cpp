@@ -1,5 +1,7 @@
 ﻿#include "Game.h"
 
+#include <algorithm>
+
 #include <include/gl.h>
 #include <include/glm.h>
 #include <include/glm_utils.h>
@@ -13,6 +15,7 @@
 
 #include <Component/AudioSource.h>
 #include <Component/AABB.h>
+#include <Component/ComponentStore.h>
 #include <Component/Mesh.h>
 #include <Component/SkinnedMesh.h>
 #include <Component/Text.h>
@@ -51,12 +54,15 @@
 #include <Manager/SceneManager.h>
 #include <Manager/ShaderManager.h>
 #include <Manager/RenderingSystem.h>
+#include <Manager/Profiler.h>
 
 #ifdef PHYSICS_ENGINE
 #include <Manager/HavokCore.h>
 #include <Manager/PhysicsManager.h>
 #endif
 
+#include <Rendering/RenderPacket.h>
+#include <Rendering/RenderQueue.h>
 #include <Rendering/SSAO.h>
 
 #include <UI/MenuSystem.h>
@@ -109,6 +115,13 @@ void Game::Init() {
 	Spot->SetDirection(glm::vec3(1, 0, 0));
 	Manager::GetDebug()->Add(Spot);
 
+	// Never added to the scene - see <point-shadows> in config.xml
+	for (unsigned int i = 0; i < Manager::GetConfig()->pointShadows; i++) {
+		PointLight *caster = new PointLight();
+		caster->InitCaster(Manager::GetConfig()->pointShadowsLayered);
+		pointCasters.push_back(caster);
+	}
+
 	ShadowMap = new Texture();
 	ShadowMap->Create2DTextureFloat(NULL, resolution.x, resolution.y, 4, 32);
 
@@ -149,17 +162,20 @@ void Game::Init() {
 
 
 	//GameObjects
-	for (uint i = 0; i < 300; i++) {
-		GameObject *tree = Manager::GetResource()->GetGameObject("bamboo");
+	vector<GameObject*> trees;
+	Manager::GetResource()->Instantiate("bamboo", 300, trees);
+	for (auto tree : trees) {
 		tree->transform->SetPosition(glm::vec3(rand() % 100 - 50, 0, rand() % 100 - 50));
 		Manager::GetScene()->AddObject(tree);
 	}
 
 
 	//GameObjects
+	vector<GameObject*> tiles;
+	Manager::GetResource()->Instantiate("ground", 100, tiles);
 	for (int i = -5; i < 5; i++) {
 		for (int j = -5; j < 5; j++) {
-			GameObject *ground = Manager::GetResource()->GetGameObject("ground");
+			GameObject *ground = tiles[(i + 5) * 10 + j + 5];
 			ground->transform->SetPosition(glm::vec3(i * 10 + 5, -0.1f, j * 10 + 5));
 			Manager::GetScene()->AddObject(ground);
 		}
@@ -168,6 +184,7 @@ void Game::Init() {
 	InitSceneCameras();
 
 	colorPicking = new ColorPicking();
+	renderQueue = new RenderQueue();
 	colorPicking->Init();
 
 	#ifdef PHYSICS_ENGINE
@@ -186,38 +203,136 @@ void Game::Init() {
 };
 
 
-void Game::Update(float elapsedTime, float deltaTime) {
-
-	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-	glClearDepth(1.0f);
-
-	double startT = glfwGetTime();
+void Game::FixedUpdate(float elapsedTime, float deltaTime) {
 
-	if (RuntimeState::STATE == RunState::GAMEPLAY) {
+	if (RuntimeState::STATE != RunState::GAMEPLAY)
+		return;
 
-		// ---------------------------//
-		// --- Physics Simulation --- //
-		// ---------------------------//
+	// ---------------------------//
+	// --- Physics Simulation --- //
+	// ---------------------------//
 
-		#ifdef PHYSICS_ENGINE
+	#ifdef PHYSICS_ENGINE
+	{
+		PROFILE_SCOPE("Physics");
 		Manager::GetHavok()->StepSimulation(deltaTime);
-		#endif
-
-		// ---------------------//
-		// --- Update Scene --- //
-		// ---------------------//
-  		InputSystem::UpdateObservers(deltaTime);
+	}
+	#endif
 
+	// ---------------------//
+	// --- Update Scene --- //
+	// ---------------------//
+	{
+		PROFILE_SCOPE("Audio");
 		Manager::GetAudio()->Update(activeCamera);
+	}
+	{
+		PROFILE_SCOPE("Events");
 		Manager::GetEvent()->Update();
+	}
+	{
+		PROFILE_SCOPE("Scene Update");
 		Manager::GetScene()->Update();
+	}
+}
 
-		if (Manager::GetDebug()->debugView) {
-			Manager::GetDebug()->BindForRendering(activeCamera);
-			Manager::GetDebug()->Render(activeCamera);
-		}
+void Game::Update(float elapsedTime, float deltaTime) {
+
+	if (RuntimeState::STATE != RunState::GAMEPLAY)
+		return;
+
+	// Per frame with the variable delta - cameras are not simulated entities and are
+	// never interpolated, so moving them only on ticks would stutter or freeze them
+	{
+		PROFILE_SCOPE("Input");
+		InputSystem::UpdateObservers(deltaTime);
+	}
 
+	// Per frame, so cells keep streaming on frames without a tick - mesh uploads
+	// need the GL thread and the simulation to be idle
+	Manager::GetScene()->StreamAround(gameCamera->transform->position);
+
+	if (Engine::IsHeadless())
+		return;
+
+	if (Manager::GetDebug()->debugView) {
+		PROFILE_SCOPE("Debug View");
+		Manager::GetDebug()->BindForRendering(activeCamera);
+		Manager::GetDebug()->Render(activeCamera);
+	}
+
+	{
+		PROFILE_SCOPE("Color Picking");
 		colorPicking->Update(activeCamera);
+	}
+}
+
+void Game::Extract(RenderPacket &packet) {
+
+	// ---------------------------------------------//
+	// --- Camera Culling and Shadow Cascades --- //
+	// ---------------------------------------------//
+
+	{
+		PROFILE_SCOPE("Culling");
+		gameCamera->UpdateBoundingBox(Sun);
+		Manager::GetScene()->UpdateBoundingBoxes(Sun->transform->rotationQ);
+		Manager::GetScene()->FrustumCulling(gameCamera);
+	}
+
+	packet.camera.Set(activeCamera);
+	packet.cullCamera.Set(gameCamera);
+	packet.splitDistances = gameCamera->splitDistances;
+	packet.cascadeViews = Sun->lightViews;
+	packet.cascadeProjections = Sun->lightProjections;
+
+	RenderView spotView;
+	spotView.Set(Spot);
+	packet.shadowViews.push_back(spotView);
+
+	// ----------------------//
+	// --- Scene Objects --- //
+	// ----------------------//
+
+	PROFILE_SCOPE("Render Items");
+
+	// Visibility and shadow flags were written to the scene entities by culling
+	auto store = Manager::GetComponents();
+	store->ForEach(ENTITY_SIMULATED, [&](EntityID entity) {
+		unsigned int flags = 0;
+		if (store->HasFlags(entity, ENTITY_VISIBLE))
+			flags |= RENDER_VISIBLE;
+		if (store->HasFlags(entity, ENTITY_IN_VIEW))
+			flags |= RENDER_IN_VIEW;
+		if (store->HasFlags(entity, ENTITY_CAST_SHADOW))
+			flags |= RENDER_CAST_SHADOW;
+
+		if (!flags)
+			return;
+
+		GameObject *obj = store->GetOwner(entity);
+		if ((flags & RENDER_VISIBLE) && obj->mesh && obj->mesh->meshType == MeshType::SKINNED)
+			obj->mesh->Update();
+
+		packet.AddObject(obj, flags);
+	});
+
+	{
+		PROFILE_SCOPE("Cascade Culling");
+		Sun->CullCasters(packet);
+	}
+
+	for (auto *light : Manager::GetScene()->lights) {
+		packet.AddLight(light);
+	}
+}
+
+void Game::Render(const RenderPacket &packet) {
+
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glClearDepth(1.0f);
+
+	if (RuntimeState::STATE == RunState::GAMEPLAY) {
 
 		// ------------------------//
 		// --- Scene Rendering --- //
@@ -235,64 +350,85 @@ void Game::Update(float elapsedTime, float deltaTime) {
 		}
 
 		{
-			Shader *R2T = Manager::GetShader()->GetShader("rendertargets");
-			R2T->Use();
-			activeCamera->BindPosition(R2T->loc_eye_pos);
-			activeCamera->BindViewMatrix(R2T->loc_view_matrix);
-			activeCamera->BindProjectionMatrix(R2T->loc_projection_matrix);
+			PROFILE_SCOPE("G-Buffer");
+			PROFILE_GPU_SCOPE("G-Buffer");
 
+			// Both shaders read the camera from the FrameData block
+			Shader *R2T = Manager::GetShader()->GetShader("rendertargets");
 			Shader *R2TSk = Manager::GetShader()->GetShader("r2tskinning");
-			R2TSk->Use();
-			activeCamera->BindPosition(R2TSk->loc_eye_pos);
-			activeCamera->BindViewMatrix(R2TSk->loc_view_matrix);
-			activeCamera->BindProjectionMatrix(R2TSk->loc_projection_matrix);
-
-			for (auto *obj : Manager::GetScene()->frustumObjects) {
-				if (obj->mesh && obj->mesh->meshType == MeshType::SKINNED) {
-					obj->mesh->Update();
-					Manager::GetShader()->PushState(R2TSk);
-					obj->Render(R2TSk);
-				}
-				else {
-					Manager::GetShader()->PushState(R2T);
-					obj->Render(R2T);
-				}
+			packet.camera.BindFrameData();
+
+			// Sorted by shader, material and mesh to skip the redundant binds
+			renderQueue->Clear();
+			unsigned int nrItems = (unsigned int)packet.items.size();
+			for (unsigned int i = 0; i < nrItems; i++) {
+				const RenderItem &item = packet.items[i];
+				if (!(item.flags & RENDER_IN_VIEW))
+					continue;
+
+				float depth = glm::distance(glm::vec3(item.model[3]), packet.camera.position) / packet.camera.zFar;
+				renderQueue->Add(RENDER_PASS_GBUFFER, (item.flags & RENDER_SKINNED) ? R2TSk : R2T, packet, i, depth);
 			}
+			renderQueue->Sort();
+			renderQueue->Submit(packet);
+
+			// Shown under the timings in the profiler view
+			const DrawState &state = renderQueue->GetState();
+			PROFILE_COUNTER("G-Buffer draws", state.draws);
+			PROFILE_COUNTER("G-Buffer instanced draws", state.instancedDraws);
+			PROFILE_COUNTER("G-Buffer instances", state.instances);
+			PROFILE_COUNTER("G-Buffer binds", state.binds);
+			PROFILE_COUNTER("G-Buffer binds avoided", state.bindsAvoided);
 		}
 
-		// -------------------------------------------//
-		// --- Camera Culling and Shadows Casting --- //
-		// -------------------------------------------//
+		// ------------------------//
+		// --- Shadows Casting --- //
+		// ------------------------//
 		{
-			gameCamera->UpdateBoundingBox(Sun);
-			for (auto *obj : Manager::GetScene()->activeObjects) {
-				if (obj->aabb) {
-					obj->aabb->Update(Sun->transform->rotationQ);
-				}
-			}
-			Manager::GetScene()->FrustumCulling(gameCamera);
-			Sun->CastShadows(gameCamera);
+			PROFILE_SCOPE("CSM");
+			PROFILE_GPU_SCOPE("CSM");
+			Sun->CastShadows(packet);
 		}
 		{
-			Spot->CastShadows();
+			PROFILE_SCOPE("Spot Shadow");
+			PROFILE_GPU_SCOPE("Spot Shadow");
+			Spot->CastShadows(packet, packet.shadowViews[0]);
 		}
 
+		unsigned int nrPointShadows = 0;
+		if (!pointCasters.empty()) {
+			PROFILE_SCOPE("Point Shadows");
+			PROFILE_GPU_SCOPE("Point Shadows");
+
+			vector<pair<float, unsigned int>> closest;
+			unsigned int nrLights = (unsigned int)packet.lights.size();
+			for (unsigned int i = 0; i < nrLights; i++)
+				closest.push_back(make_pair(glm::distance(packet.camera.position, packet.lights[i].position), i));
+
+			nrPointShadows = nrLights < pointCasters.size() ? nrLights : (unsigned int)pointCasters.size();
+			partial_sort(closest.begin(), closest.begin() + nrPointShadows, closest.end());
+			for (unsigned int k = 0; k < nrPointShadows; k++)
+				pointCasters[k]->CastShadows(packet, packet.lights[closest[k].second]);
+		}
 
 		///////////////////////////////////////////////////////////////////////////
 		// Accumulate shadows using a compute shader
 		{
+			PROFILE_SCOPE("Shadow Accumulation");
+			PROFILE_GPU_SCOPE("Shadow Accumulation");
+
 			Shader *sha = Manager::GetShader()->GetShader("CSMShadowMap");
 			sha->Use();
 
 			FBO->BindDepthTexture(GL_TEXTURE0);
-			gameCamera->BindProjectionDistances(sha);
+			packet.cullCamera.BindProjectionDistances(sha);
 
 			glBindImageTexture(0, FBO->textures[0].GetTextureID(), 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA32F);
 			glBindImageTexture(1, FBO->textures[1].GetTextureID(), 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
 			glBindImageTexture(2, ShadowMap->GetTextureID(), 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA32F);
 
 			{
-				Sun->BindForUse(sha, gameCamera);
+				Sun->BindForUse(sha, packet);
 				glUniform1i(sha->loc_shadowID, 0);
 
 				glDispatchCompute(GLuint(UPPER_BOUND(FBO->GetResolution().x, 16)), GLuint(UPPER_BOUND(FBO->GetResolution().y, 16)), 1);
@@ -304,13 +440,22 @@ void Game::Update(float elapsedTime, float deltaTime) {
 			sha = Manager::GetShader()->GetShader("ShadowMap");
 			sha->Use();
 			{
-				Spot->BindForUse(sha);
+				Spot->BindForUse(sha, packet.shadowViews[0]);
 				glUniform1i(sha->loc_shadowID, 100);
 
 				glDispatchCompute(GLuint(UPPER_BOUND(FBO->GetResolution().x, 16)), GLuint(UPPER_BOUND(FBO->GetResolution().y, 16)), 1);
 				glFinish();
 				glMemoryBarrier(GL_ALL_BARRIER_BITS);
 			}
+
+			for (unsigned int k = 0; k < nrPointShadows; k++) {
+				pointCasters[k]->BindForUse(sha);
+				glUniform1i(sha->loc_shadowID, 200);
+
+				glDispatchCompute(GLuint(UPPER_BOUND(FBO->GetResolution().x, 16)), GLuint(UPPER_BOUND(FBO->GetResolution().y, 16)), 1);
+				glFinish();
+				glMemoryBarrier(GL_ALL_BARRIER_BITS);
+			}
 		}
 		///////////////////////////////////////////////////////////////////////////	
 
@@ -323,6 +468,9 @@ void Game::Update(float elapsedTime, float deltaTime) {
 
 			// --- Deferred Lighting --- //
 			{
+				PROFILE_SCOPE("Deferred Lights");
+				PROFILE_GPU_SCOPE("Deferred Lights");
+
 				FBO_Light->Bind();
 				glDepthMask(GL_FALSE);
 				glEnable(GL_BLEND);
@@ -335,16 +483,16 @@ void Game::Update(float elapsedTime, float deltaTime) {
 				DF->Use();
 
 				FBO_Light->SendResolution(DF);
-				activeCamera->BindPosition(DF->loc_eye_pos);
-				activeCamera->BindViewMatrix(DF->loc_view_matrix);
-				activeCamera->BindProjectionMatrix(DF->loc_projection_matrix);
+				packet.camera.BindPosition(DF->loc_eye_pos);
+				packet.camera.BindViewMatrix(DF->loc_view_matrix);
+				packet.camera.BindProjectionMatrix(DF->loc_projection_matrix);
 
 				FBO->BindTexture(1, GL_TEXTURE0);
 				FBO->BindTexture(2, GL_TEXTURE1);
 
-				for (auto *light: Manager::GetScene()->lights) {
-					(activeCamera->DistTo(light) < light->effectRadius) ? glCullFace(GL_FRONT) : glCullFace(GL_BACK);
-					light->RenderDeferred(DF);
+				for (auto &light : packet.lights) {
+					(glm::distance(packet.camera.position, light.position) < light.radius) ? glCullFace(GL_FRONT) : glCullFace(GL_BACK);
+					PointLight::RenderDeferred(DF, light);
 				}
 
 				glDepthMask(GL_TRUE);
@@ -354,7 +502,9 @@ void Game::Update(float elapsedTime, float deltaTime) {
 
 			// --- Screen Space Ambient Occlusion (SSAO) --- //
 			if (Manager::GetRenderSys()->Is(RenderState::SS_AO)) {
-				ssao->Update(FBO, activeCamera);
+				PROFILE_SCOPE("SSAO");
+				PROFILE_GPU_SCOPE("SSAO");
+				ssao->Update(FBO, packet.camera);
 			}
 
 			// --- Render to the screen --- //
@@ -364,12 +514,15 @@ void Game::Update(float elapsedTime, float deltaTime) {
 			FrameBuffer::Clear();
 			glDepthMask(GL_FALSE);
 			{
+				PROFILE_SCOPE("Composition");
+				PROFILE_GPU_SCOPE("Composition");
+
 				Shader *Composition = Manager::GetShader()->GetShader("composition");
 				Composition->Use();
 				glUniform2f(Composition->loc_resolution, (float)Engine::Window->resolution.x, (float)Engine::Window->resolution.y);
 				glUniform1i(Composition->active_ssao, Manager::GetRenderSys()->Is(RenderState::SS_AO));
 				glUniform1i(Composition->loc_debug_view, Manager::GetDebug()->debugView);
-				activeCamera->BindProjectionDistances(Composition);
+				packet.camera.BindProjectionDistances(Composition);
 
 				FBO->BindTexture(0, GL_TEXTURE0);
 				FBO_Light->BindTexture(0, GL_TEXTURE1);
@@ -387,7 +540,7 @@ void Game::Update(float elapsedTime, float deltaTime) {
 				Shader *Debug = Manager::GetShader()->GetShader("debug");
 				Debug->Use();
 				glUniform1i(Debug->loc_debug_id, Manager::GetRenderSys()->debugParam);
-				activeCamera->BindProjectionDistances(Debug);
+				packet.camera.BindProjectionDistances(Debug);
 				//glm::BindUniform3f(Debug->loc_eye_pos, PLSC->transform->position);
 
 				glDisable(GL_DEPTH_TEST);
@@ -411,29 +564,35 @@ void Game::Update(float elapsedTime, float deltaTime) {
 		}
 	}
 
-	Manager::GetMenu()->RenderMenu();
-	
-	double endT = glfwGetTime();
-	//fprintf(stderr, "FRAME TIME: %.2lf ms, DELTA TIME: %d ms\n", (endT - startT) * 1000, int(deltaTime * 1000));
+	{
+		PROFILE_SCOPE("Menu");
+		PROFILE_GPU_SCOPE("Menu");
+		Manager::GetMenu()->RenderMenu();
+	}
+
+	Manager::GetDebug()->RenderProfiler();
 }
 
 void Game::BarrelPhysicsTest(bool pointLights)
 {
 #ifdef PHYSICS_ENGINE
 	glm::vec3 pos = gameCamera->transform->position;
-	GameObject *barrel = Manager::GetResource()->GetGameObject("oildrum");
-	for (int i=0; i<100; i++) {
-		if (pointLights) {
+	if (pointLights) {
+		const GameObject *barrel = Manager::GetResource()->GetPrefab("oildrum");
+		for (int i=0; i<100; i++) {
 			PointLight *obj = new PointLight(*barrel);
 			obj->transform->position = pos; // +glm::vec3(rand() % 10 - 5, rand() % 5 + 5, rand() % 10 - 5);
 			Manager::GetScene()->lights.push_back(obj);
 			Manager::GetScene()->AddObject(obj);
 		}
-		else {
-			GameObject *obj = new GameObject(*barrel);
-			obj->transform->position = glm::vec3(rand() % 10 - 5, rand() % 5 + 5, rand() % 10 - 5);
-			Manager::GetScene()->AddObject(obj);
-		}
+		return;
+	}
+
+	vector<GameObject*> barrels;
+	Manager::GetResource()->Instantiate("oildrum", 100, barrels);
+	for (auto obj : barrels) {
+		obj->transform->position = glm::vec3(rand() % 10 - 5, rand() % 5 + 5, rand() % 10 - 5);
+		Manager::GetScene()->AddObject(obj);
 	}
 #endif
 }
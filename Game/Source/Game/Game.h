@@ -11,11 +11,14 @@ class CameraInput;
 class CameraDebugInput;
 class ColorPicking;
 class DirectionalLight;
+class PointLight;
 class SpotLight;
 class FrameBuffer;
 class GameObject;
 class Overlay;
 class Player;
+class RenderPacket;
+class RenderQueue;
 class SSAO;
 class CSM;
 class Texture;
@@ -27,7 +30,10 @@ class Game : public World,
 		Game();
 		~Game();
 		void Init();
+		void FixedUpdate(float elapsedTime, float deltaTime);
 		void Update(float elapsedTime, float deltaTime);
+		void Extract(RenderPacket &packet);
+		void Render(const RenderPacket &packet);
 
 		void BarrelPhysicsTest(bool pointLights);
 
@@ -48,6 +54,9 @@ class Game : public World,
 		DirectionalLight	*Sun;
 		SpotLight			*Spot;
 
+		// Render side cube shadow casters, given to the closest packet lights
+		vector<PointLight*>	pointCasters;
+
 		FrameBuffer			*FBO;
 		FrameBuffer			*FBO_Light;
 
@@ -59,6 +68,7 @@ class Game : public World,
 		CSM					*csm;
 
 		ColorPicking		*colorPicking;
+		RenderQueue			*renderQueue;
 
 		vector<Camera*>		sceneCameras;
 		unsigned int		activeSceneCamera;
@@ -7,9 +7,24 @@ uniform mat4 Model;
 uniform mat4 View;
 uniform mat4 Projection;
 
+// Instanced draws read the model matrix from the instance buffer
+uniform bool instanced;
+uniform int instance_offset;
+uniform samplerBuffer instance_data;
+
 layout(location = 0) out vec2 texture_coord;
+layout(location = 1) flat out vec4 instance_color;
+
+mat4 GetModel() {
+	if (!instanced)
+		return Model;
+	int base = (instance_offset + gl_InstanceID) * 5;
+	return mat4(texelFetch(instance_data, base), texelFetch(instance_data, base + 1),
+				texelFetch(instance_data, base + 2), texelFetch(instance_data, base + 3));
+}
 
 void main() {
 	texture_coord = v_texture_coord;
-	gl_Position = Projection * View * Model * vec4(v_position, 1.0);
+	instance_color = instanced ? texelFetch(instance_data, (instance_offset + gl_InstanceID) * 5 + 4) : vec4(0);
+	gl_Position = Projection * View * GetModel() * vec4(v_position, 1.0);
 }
@@ -5,8 +5,19 @@ layout(location = 1) in vec2 v_texture_coord;
 layout(location = 2) in vec3 v_normal;
 
 uniform mat4 Model;
-uniform mat4 View;
-uniform mat4 Projection;
+
+// Camera of the pass - written once per view to the frame ring (see RenderView::BindFrameData)
+layout(std140) uniform FrameData {
+	mat4 View;
+	mat4 Projection;
+	vec4 eye_position;
+	vec4 z_planes;			// near, far
+};
+
+// Instanced draws read the model matrix from the instance buffer
+uniform bool instanced;
+uniform int instance_offset;
+uniform samplerBuffer instance_data;
 
 layout(location = 0) out vec2 texture_coord;
 layout(location = 1) out vec4 world_position;
@@ -15,11 +26,20 @@ layout(location = 3) out vec4 view_position;
 layout(location = 4) out vec4 view_normal;
 layout(location = 5) out vec4 screen_position;
 
+mat4 GetModel() {
+	if (!instanced)
+		return Model;
+	int base = (instance_offset + gl_InstanceID) * 5;
+	return mat4(texelFetch(instance_data, base), texelFetch(instance_data, base + 1),
+				texelFetch(instance_data, base + 2), texelFetch(instance_data, base + 3));
+}
+
 void main() {
 	texture_coord = v_texture_coord;
 
-	world_position = Model * vec4(v_position, 1.0);
-	world_normal = Model * vec4(v_normal, 1.0);
+	mat4 model = GetModel();
+	world_position = model * vec4(v_position, 1.0);
+	world_normal = model * vec4(v_normal, 1.0);
 
 	view_position = View * world_position;
 	view_normal = View * world_normal;
@@ -4,14 +4,33 @@ layout(location = 0) in vec3 v_position;
 layout(location = 1) in vec2 v_texture_coord;
 
 uniform mat4 Model;
-uniform mat4 View;
-uniform mat4 Projection;
+
+// Camera of the pass - written once per view to the frame ring (see RenderView::BindFrameData)
+layout(std140) uniform FrameData {
+	mat4 View;
+	mat4 Projection;
+	vec4 eye_position;
+	vec4 z_planes;			// near, far
+};
+
+// Instanced draws read the model matrix from the instance buffer
+uniform bool instanced;
+uniform int instance_offset;
+uniform samplerBuffer instance_data;
 
 layout(location = 0) out vec4 v_pos;
 layout(location = 1) out vec2 texture_coord;
 
+mat4 GetModel() {
+	if (!instanced)
+		return Model;
+	int base = (instance_offset + gl_InstanceID) * 5;
+	return mat4(texelFetch(instance_data, base), texelFetch(instance_data, base + 1),
+				texelFetch(instance_data, base + 2), texelFetch(instance_data, base + 3));
+}
+
 void main() {
-	gl_Position = Projection * View * Model * vec4(v_position, 1.0);
+	gl_Position = Projection * View * GetModel() * vec4(v_position, 1.0);
 	v_pos = gl_Position;
 	texture_coord = v_texture_coord;
 }
@@ -85,18 +85,26 @@ float linearDepth(float depth) {
 	return z;
 }
 
+// Point light cube map - zNear / zFar are the cube face projection planes
 float ChebyshevUpperBound2()
 {
-	return 1.0;
 	vec4 world_position = imageLoad(worldPosition, pixel); 
 	vec3 lightDir = world_position.xyz - light_position;
-	float dist = length(lightDir);
+
+	// The face holding lightDir looks down its dominant axis
+	float axis = max(abs(lightDir.x), max(abs(lightDir.y), abs(lightDir.z)));
+	if (axis >= zFar) return 1.0;
+
+	float depth = (zFar + zNear - 2.0 * zFar * zNear / axis) / (zFar - zNear) * 0.5 + 0.5;
 	vec2 moments = texture(u_texture_cube_2, lightDir).xy;
 
+	if (depth <= moments.x)
+		return 1.0;
+
 	float variance = moments.y - (moments.x * moments.x);
 	variance = max(variance, 0.0001);
 
-	float delta = 1.0 - moments.x;
+	float delta = depth - moments.x;
 	float p_max = variance / (variance + delta * delta);
 
 	return mix(0.8, 1.0, p_max);
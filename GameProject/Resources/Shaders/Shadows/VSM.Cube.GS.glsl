@@ -0,0 +1,29 @@
+#version 410
+layout(triangles) in;
+layout(triangle_strip, max_vertices = 18) out;
+
+// cube faces in GL_TEXTURE_CUBE_MAP_POSITIVE_X + layer order
+uniform mat4 CubeView[6];
+uniform mat4 Projection;
+uniform int face_mask;
+
+layout(location = 0) in vec2 geom_texture_coord[];
+
+layout(location = 0) out vec4 frag_pos;
+layout(location = 1) out vec2 texture_coord;
+
+void main() {
+	for (int face = 0; face < 6; face++) {
+		if ((face_mask & (1 << face)) == 0)
+			continue;
+
+		gl_Layer = face;
+		for (int i = 0; i < 3; i++) {
+			gl_Position = Projection * CubeView[face] * gl_in[i].gl_Position;
+			frag_pos = gl_Position;
+			texture_coord = geom_texture_coord[i];
+			EmitVertex();
+		}
+		EndPrimitive();
+	}
+}
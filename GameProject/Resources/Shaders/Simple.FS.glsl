@@ -1,8 +1,11 @@
 #version 410
 layout(location = 0) out vec4 fragColor;
 
+layout(location = 1) flat in vec4 instance_color;
+
+uniform bool instanced;
 uniform vec4 debug_color;
 
 void main() {
-	fragColor = debug_color;
+	fragColor = instanced ? instance_color : debug_color;
 }
\ No newline at end of file
@@ -1,5 +1,4 @@
 #version 410
-#define MAX_BONES 100
 
 layout(location = 0) in vec3 v_position;
 layout(location = 1) in vec2 v_texture_coord;
@@ -8,9 +7,23 @@ layout(location = 3) in ivec4 v_boneIds;
 layout(location = 4) in vec4 v_weights;
 
 uniform mat4 Model;
-uniform mat4 View;
-uniform mat4 Projection;
-uniform mat4 Bones[MAX_BONES];
+
+// Camera of the pass - written once per view to the frame ring (see RenderView::BindFrameData)
+layout(std140) uniform FrameData {
+	mat4 View;
+	mat4 Projection;
+	vec4 eye_position;
+	vec4 z_planes;			// near, far
+};
+
+// Instanced draws read the model matrix and the palette offset from the instance buffer
+uniform bool instanced;
+uniform int instance_offset;
+uniform samplerBuffer instance_data;
+
+// Bone palettes are packed in the frame ring - 4 texels per matrix
+uniform int bone_offset;
+uniform samplerBuffer bone_data;
 
 layout(location = 0) out vec2 texture_coord;
 layout(location = 1) out vec4 world_position;
@@ -18,17 +31,35 @@ layout(location = 2) out vec4 world_normal;
 layout(location = 3) out vec4 view_position;
 layout(location = 4) out vec4 view_normal;
 
+int palette;
+
+mat4 GetModel() {
+	if (!instanced)
+		return Model;
+	int base = (instance_offset + gl_InstanceID) * 5;
+	return mat4(texelFetch(instance_data, base), texelFetch(instance_data, base + 1),
+				texelFetch(instance_data, base + 2), texelFetch(instance_data, base + 3));
+}
+
+mat4 GetBone(int id) {
+	int base = (palette + id) * 4;
+	return mat4(texelFetch(bone_data, base), texelFetch(bone_data, base + 1),
+				texelFetch(bone_data, base + 2), texelFetch(bone_data, base + 3));
+}
+
 void main() {
 	texture_coord = v_texture_coord;
+	palette = instanced ? int(texelFetch(instance_data, (instance_offset + gl_InstanceID) * 5 + 4).x) : bone_offset;
 
 	mat4 BoneTransform = mat4(1.0);
-    BoneTransform += Bones[v_boneIds[1]] * v_weights[1];
-    BoneTransform  = Bones[v_boneIds[0]] * v_weights[0];
-    BoneTransform += Bones[v_boneIds[2]] * v_weights[2];
-    BoneTransform += Bones[v_boneIds[3]] * v_weights[3];
+    BoneTransform += GetBone(v_boneIds[1]) * v_weights[1];
+    BoneTransform  = GetBone(v_boneIds[0]) * v_weights[0];
+    BoneTransform += GetBone(v_boneIds[2]) * v_weights[2];
+    BoneTransform += GetBone(v_boneIds[3]) * v_weights[3];
 	
-	world_position = Model * BoneTransform * vec4(v_position, 1.0);
-	world_normal = Model * BoneTransform * vec4(v_normal, 1.0);
+	mat4 model = GetModel();
+	world_position = model * BoneTransform * vec4(v_position, 1.0);
+	world_normal = model * BoneTransform * vec4(v_normal, 1.0);
 	world_position[1] = -world_position[1];
 	world_position[0] = -world_position[0];
 	